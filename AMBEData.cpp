@@ -18,52 +18,27 @@
  */
 
 #include <cassert>
-#include <string>
 #include <cstring>
+#include <type_traits>
 #include "AMBEData.h"
 #include "DStarDefines.h"
 #include "Utils.h"
 
+static_assert(std::is_trivially_copyable<CAMBEData>::value, "CAMBEData must stay trivially copyable");
+
 CAMBEData::CAMBEData() :
 m_rptSeq(0U),
-m_outSeq(0U),
-m_id(0U),
-m_band1(0x00U),
-m_band2(0x02U),
-m_band3(0x01U),
-m_data(NULL),
 m_yourAddress(),
+m_id(0U),
 m_yourPort(0U),
 m_myPort(0U),
 m_errors(0U),
-m_text(),
-m_header()
-{
-	m_data = new unsigned char[DV_FRAME_LENGTH_BYTES];
-}
-
-CAMBEData::CAMBEData(const CAMBEData& data) :
-m_rptSeq(data.m_rptSeq),
-m_outSeq(data.m_outSeq),
-m_id(data.m_id),
-m_band1(data.m_band1),
-m_band2(data.m_band2),
-m_band3(data.m_band3),
-m_data(NULL),
-m_yourAddress(data.m_yourAddress),
-m_yourPort(data.m_yourPort),
-m_myPort(data.m_myPort),
-m_errors(data.m_errors),
-m_text(data.m_text),
-m_header(data.m_header)
-{
-	m_data = new unsigned char[DV_FRAME_LENGTH_BYTES];
-	::memcpy(m_data, data.m_data, DV_FRAME_LENGTH_BYTES);
-}
-
-CAMBEData::~CAMBEData()
+m_outSeq(0U),
+m_band1(0x00U),
+m_band2(0x02U),
+m_band3(0x01U)
 {
-	delete[] m_data;
+	::memset(m_data, 0x00U, DV_FRAME_LENGTH_BYTES);
 }
 
 bool CAMBEData::setIcomRepeaterData(const unsigned char *data, unsigned int length, const in_addr& yourAddress, unsigned int yourPort)
@@ -189,8 +164,6 @@ bool CAMBEData::setDCSData(const unsigned char *data, unsigned int length, const
 	assert(data != NULL);
 	assert(length >= 100U);
 
-	m_header.setDCSData(data, length, yourAddress, yourPort, myPort);
-
 	m_id     = data[44] * 256U + data[43];
 
 	m_outSeq = data[45];
@@ -211,8 +184,6 @@ bool CAMBEData::setCCSData(const unsigned char *data, unsigned int length, const
 	assert(data != NULL);
 	assert(length >= 100U);
 
-	m_header.setCCSData(data, length, yourAddress, yourPort, myPort);
-
 	m_id     = data[44] * 256U + data[43];
 
 	m_outSeq = data[45];
@@ -391,7 +362,7 @@ unsigned int CAMBEData::getDPlusData(unsigned char* data, unsigned int length) c
 	}
 }
 
-unsigned int CAMBEData::getDCSData(unsigned char* data, unsigned int length) const
+unsigned int CAMBEData::getDCSData(const CHeaderData& header, unsigned char* data, unsigned int length) const
 {
 	assert(data != NULL);
 	assert(length >= 100U);
@@ -425,15 +396,12 @@ unsigned int CAMBEData::getDCSData(unsigned char* data, unsigned int length) con
 
 	data[63] = 0x21U;
 
-	for (unsigned int i = 0U; i < m_text.size(); i++)
-		data[64 + i] = m_text[i];
-
-	m_header.getDCSData(data, 100U);
+	header.getDCSData(data, 100U);
 
 	return 100U;
 }
 
-unsigned int CAMBEData::getCCSData(unsigned char* data, unsigned int length) const
+unsigned int CAMBEData::getCCSData(const CHeaderData& header, unsigned char* data, unsigned int length) const
 {
 	assert(data != NULL);
 	assert(length >= 100U);
@@ -467,12 +435,9 @@ unsigned int CAMBEData::getCCSData(unsigned char* data, unsigned int length) con
 
 	data[63] = 0x21U;
 
-	for (unsigned int i = 0U; i < m_text.size(); i++)
-		data[64 + i] = m_text[i];
-
 	data[93U] = 0x36U;
 
-	m_header.getCCSData(data, 100U);
+	header.getCCSData(data, 100U);
 
 	return 100U;
 }
@@ -561,11 +526,6 @@ void CAMBEData::setDestination(const in_addr& address, unsigned int port)
 	m_yourPort    = port;
 }
 
-void CAMBEData::setText(const std::string& text)
-{
-	m_text = text;
-}
-
 in_addr CAMBEData::getYourAddress() const
 {
 	return m_yourAddress;
@@ -581,11 +541,6 @@ unsigned int CAMBEData::getMyPort() const
 	return m_myPort;
 }
 
-CHeaderData& CAMBEData::getHeader()
-{
-	return m_header;
-}
-
 unsigned int CAMBEData::getErrors() const
 {
 	return m_errors;
@@ -608,25 +563,3 @@ unsigned int CAMBEData::getData(unsigned char *data, unsigned int length) const
 
 	return DV_FRAME_LENGTH_BYTES;
 }
-
-CAMBEData& CAMBEData::operator=(const CAMBEData& data)
-{
-	if (&data != this) {
-		m_rptSeq      = data.m_rptSeq;
-		m_outSeq      = data.m_outSeq;
-		m_id          = data.m_id;
-		m_band1       = data.m_band1;
-		m_band2       = data.m_band2;
-		m_band3       = data.m_band3;
-		m_yourAddress = data.m_yourAddress;
-		m_yourPort    = data.m_yourPort;
-		m_myPort      = data.m_myPort;
-		m_errors      = data.m_errors;
-		m_text        = data.m_text;
-		m_header      = data.m_header;
-
-		::memcpy(m_data, data.m_data, DV_FRAME_LENGTH_BYTES);
-	}
-
-	return *this;
-}
@@ -19,22 +19,25 @@
 
 #pragma once
 
-#include <string>
+#include <cstdint>
 
 #include <netinet/in.h>
 #include "HeaderData.h"
+#include "DStarDefines.h"
 
+// One voice frame, with its payload stored inline. It is trivially copyable and
+// small, so frames are cheap to copy, queue and batch. The header fields that a
+// protocol repeats in every frame, DCS and CCS, come from the stream's CHeaderData.
 class CAMBEData {
 public:
 	CAMBEData();
-	CAMBEData(const CAMBEData& data);
-	~CAMBEData();
 
 	bool setIcomRepeaterData(const unsigned char* data, unsigned int length, const in_addr& yourAddress, unsigned int yourPort);
 	bool setHBRepeaterData(const unsigned char* data, unsigned int length, const in_addr& yourAddress, unsigned int yourPort);
 	bool setG2Data(const unsigned char* data, unsigned int length, const in_addr& yourAddress, unsigned int yourPort);
 	bool setDExtraData(const unsigned char* data, unsigned int length, const in_addr& yourAddress, unsigned int yourPort, unsigned int myPort);
 	bool setDPlusData(const unsigned char* data, unsigned int length, const in_addr& yourAddress, unsigned int yourPort, unsigned int myPort);
+	// Only the frame, the header in the packet is read with CHeaderData::setDCSData()
 	bool setDCSData(const unsigned char* data, unsigned int length, const in_addr& yourAddress, unsigned int yourPort, unsigned int myPort);
 	bool setCCSData(const unsigned char* data, unsigned int length, const in_addr& yourAddress, unsigned int yourPort, unsigned int myPort);
 
@@ -42,8 +45,8 @@ public:
 	unsigned int getHBRepeaterData(unsigned char* data, unsigned int length) const;
 	unsigned int getDExtraData(unsigned char* data, unsigned int length) const;
 	unsigned int getDPlusData(unsigned char* data, unsigned int length) const;
-	unsigned int getDCSData(unsigned char* data, unsigned int length) const;
-	unsigned int getCCSData(unsigned char* data, unsigned int length) const;
+	unsigned int getDCSData(const CHeaderData& header, unsigned char* data, unsigned int length) const;
+	unsigned int getCCSData(const CHeaderData& header, unsigned char* data, unsigned int length) const;
 	unsigned int getG2Data(unsigned char* data, unsigned int length) const;
 
 	unsigned int getId() const;
@@ -72,30 +75,22 @@ public:
 
 	void setDestination(const in_addr& address, unsigned int port);
 
-	void setText(const std::string& text);
-
 	in_addr      getYourAddress() const;
 	unsigned int getYourPort() const;
 	unsigned int getMyPort() const;
 
 	unsigned int getErrors() const;
 
-	CHeaderData& getHeader();
-
-	CAMBEData& operator=(const CAMBEData& data);
-
 private:
-	unsigned int   m_rptSeq;
+	uint32_t       m_rptSeq;
+	in_addr        m_yourAddress;
+	uint16_t       m_id;
+	uint16_t       m_yourPort;
+	uint16_t       m_myPort;
+	uint16_t       m_errors;
 	unsigned char  m_outSeq;
-	unsigned int   m_id;
 	unsigned char  m_band1;
 	unsigned char  m_band2;
 	unsigned char  m_band3;
-	unsigned char* m_data;
-	in_addr        m_yourAddress;
-	unsigned int   m_yourPort;
-	unsigned int   m_myPort;
-	unsigned int   m_errors;
-	std::string       m_text;
-	CHeaderData    m_header;
+	unsigned char  m_data[DV_FRAME_LENGTH_BYTES];
 };
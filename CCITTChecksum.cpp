@@ -51,6 +51,28 @@ static const unsigned short ccittTab[] = {
 	0xf78f,0xe606,0xd49d,0xc514,0xb1ab,0xa022,0x92b9,0x8330,
 	0x7bc7,0x6a4e,0x58d5,0x495c,0x3de3,0x2c6a,0x1ef1,0x0f78};
 
+// Slicing-by-8: sliceTab[n][b] is the effect of byte b followed by n zero bytes,
+// so eight bytes can be folded into the CRC with eight independent lookups
+class CCCITTSliceTable {
+public:
+	CCCITTSliceTable()
+	{
+		for (unsigned int i = 0U; i < 256U; i++)
+			m_tab[0U][i] = ccittTab[i];
+
+		for (unsigned int n = 1U; n < 8U; n++) {
+			for (unsigned int i = 0U; i < 256U; i++) {
+				uint16_t prev = m_tab[n - 1U][i];
+				m_tab[n][i] = (prev >> 8) ^ ccittTab[prev & 0x00FF];
+			}
+		}
+	}
+
+	uint16_t m_tab[8U][256U];
+};
+
+static const CCCITTSliceTable sliceTab;
+
 
 CCCITTChecksum::CCCITTChecksum() :
 m_crc(0xFFFF)
@@ -65,13 +87,25 @@ void CCCITTChecksum::update(const unsigned char* data, unsigned int length)
 {
 	assert(data != NULL);
 
-	for (unsigned int i = 0U; i < length; i++) {
-		unsigned short byte = data[i];
+	const uint16_t (*tab)[256U] = sliceTab.m_tab;
 
-		unsigned short tmp = (m_crc & 0x00FF) ^ byte;
+	uint16_t crc = m_crc;
 
-		m_crc = (m_crc >> 8) ^ ccittTab[tmp];
+	while (length >= 8U) {
+		crc ^= data[0] | (data[1] << 8);
+
+		crc = tab[7][crc & 0x00FF] ^ tab[6][crc >> 8] ^
+			  tab[5][data[2]] ^ tab[4][data[3]] ^ tab[3][data[4]] ^
+			  tab[2][data[5]] ^ tab[1][data[6]] ^ tab[0][data[7]];
+
+		data   += 8U;
+		length -= 8U;
 	}
+
+	while (length-- > 0U)
+		crc = (crc >> 8) ^ ccittTab[(crc & 0x00FF) ^ *data++];
+
+	m_crc = crc;
 }
 
 void CCCITTChecksum::update(const bool* data)
@@ -52,10 +52,10 @@ unsigned int CCCSProtocolHandler::getPort() const
 	return m_myPort;
 }
 
-bool CCCSProtocolHandler::writeData(const CAMBEData& data)
+bool CCCSProtocolHandler::writeData(const CHeaderData& header, const CAMBEData& data)
 {
 	unsigned char buffer[100U];
-	unsigned int length = data.getCCSData(buffer, 100U);
+	unsigned int length = data.getCCSData(header, buffer, 100U);
 
 #if defined(DUMP_TX)
 	CUtils::dump("Sending Data", buffer, length);
@@ -165,20 +165,14 @@ bool CCCSProtocolHandler::readPackets()
 	return true;
 }
 
-CAMBEData* CCCSProtocolHandler::readData()
+bool CCCSProtocolHandler::readData(CHeaderData& header, CAMBEData& data)
 {
 	if (m_type != CT_DATA)
-		return NULL;
+		return false;
 
-	CAMBEData* data = new CAMBEData;
+	header.setCCSData(m_buffer, m_length, m_yourAddress, m_yourPort, m_myPort);
 
-	bool res = data->setCCSData(m_buffer, m_length, m_yourAddress, m_yourPort, m_myPort);
-	if (!res) {
-		delete data;
-		return NULL;
-	}
-
-	return data;
+	return data.setCCSData(m_buffer, m_length, m_yourAddress, m_yourPort, m_myPort);
 }
 
 CConnectData* CCCSProtocolHandler::readConnect()
@@ -46,14 +46,14 @@ public:
 
 	unsigned int getPort() const;
 
-	bool writeData(const CAMBEData& data);
+	bool writeData(const CHeaderData& header, const CAMBEData& data);
 	bool writeConnect(const CConnectData& connect);
 	bool writePoll(const CPollData& poll);
 	bool writeHeard(const CHeardData& heard);
 	bool writeMisc(const CCCSData& data);
 
 	CCS_TYPE      read();
-	CAMBEData*    readData();
+	bool          readData(CHeaderData& header, CAMBEData& data);
 	CPollData*    readPoll();
 	CConnectData* readConnect();
 	CCCSData*     readMisc();
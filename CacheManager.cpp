@@ -17,6 +17,8 @@
  *   Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
  */
 
+#include <cstdio>
+
 #include "CacheManager.h"
 #include "DStarDefines.h"
 
@@ -25,111 +27,210 @@ m_userCache(),
 m_gatewayCache(),
 m_repeaterCache()
 {
+	// The IRC updates come in bursts, they mustn't wait for a gap in the finds
+	pthread_rwlockattr_t attr;
+	::pthread_rwlockattr_init(&attr);
+	::pthread_rwlockattr_setkind_np(&attr, PTHREAD_RWLOCK_PREFER_WRITER_NONRECURSIVE_NP);
+	::pthread_rwlock_init(&m_lock, &attr);
+	::pthread_rwlockattr_destroy(&attr);
 }
 
 CCacheManager::~CCacheManager()
 {
+	::pthread_rwlock_destroy(&m_lock);
 }
 
-// returns a new CUserData if there is a user and a and gateway
-CUserData *CCacheManager::findUser(const std::string& user)
+// true if there is a user and a gateway for their repeater
+bool CCacheManager::findUser(const std::string& user, CUserData& data)
 {
-	mux.lock();
-	CUserRecord *ur = m_userCache.find(user);
-	if (ur == NULL) {
-		mux.unlock();
-		return NULL;
+	CCallsign usr(user);
+	bool found = false;
+
+	::pthread_rwlock_rdlock(&m_lock);
+	const CUserRecord *ur = m_userCache.find(usr);
+	if (ur != NULL) {
+		const CRepeaterRecord *rr = m_repeaterCache.find(ur->getRepeater());
+		CCallsign gateway = (rr == NULL) ? ur->getRepeater().getGateway() : rr->getGateway();
+
+		const CGatewayRecord *gr = m_gatewayCache.find(gateway);
+		if (gr != NULL) {
+			data = CUserData(usr, ur->getRepeater(), gr->getGateway(), gr->getAddress());
+			found = true;
+		}
 	}
+	::pthread_rwlock_unlock(&m_lock);
+
+	return found;
+}
 
-	std::string gateway(ur->getRepeater()); // it's not a gateway yet
-	CRepeaterRecord *rr = m_repeaterCache.find(gateway);
-	if (rr == NULL) {
-		gateway = ur->getRepeater();
-		gateway.resize(LONG_CALLSIGN_LENGTH - 1U, ' ');
-		gateway.push_back('G');	          // now it's a gateway
-	} else
-		gateway = rr->getGateway();
-
-	CGatewayRecord *gr = m_gatewayCache.find(gateway);
-	if (gr == NULL) {
-		mux.unlock();
-		return NULL;
+bool CCacheManager::findGateway(const std::string& gateway, CGatewayData& data)
+{
+	CCallsign gw(gateway);
+	bool found = false;
+
+	::pthread_rwlock_rdlock(&m_lock);
+	const CGatewayRecord *gr = m_gatewayCache.find(gw);
+	if (gr != NULL) {
+		data = CGatewayData(gw, gr->getAddress(), gr->getProtocol());
+		found = true;
 	}
+	::pthread_rwlock_unlock(&m_lock);
 
-	CUserData *userdata =  new CUserData(user, ur->getRepeater(), gr->getGateway(), gr->getAddress());
-	mux.unlock();
-	return userdata;
+	return found;
 }
 
-CGatewayData *CCacheManager::findGateway(const std::string& gateway)
+bool CCacheManager::findRepeater(const std::string& repeater, CRepeaterData& data)
 {
-	mux.lock();
-	CGatewayRecord *gr = m_gatewayCache.find(gateway);
-	if (gr == NULL)
-		return NULL;
+	CCallsign rpt(repeater);
+	bool found = false;
+
+	::pthread_rwlock_rdlock(&m_lock);
+	const CRepeaterRecord *rr = m_repeaterCache.find(rpt);
+	CCallsign gateway = (rr == NULL) ? rpt.getGateway() : rr->getGateway();
 
-	CGatewayData *gatewaydata = new CGatewayData(gateway, gr->getAddress(), gr->getProtocol());
-	mux.unlock();
-	return gatewaydata;
+	const CGatewayRecord *gr = m_gatewayCache.find(gateway);
+	if (gr != NULL) {
+		data = CRepeaterData(rpt, gr->getGateway(), gr->getAddress(), gr->getProtocol());
+		found = true;
+	}
+	::pthread_rwlock_unlock(&m_lock);
+
+	return found;
 }
 
-CRepeaterData* CCacheManager::findRepeater(const std::string& repeater)
+void CCacheManager::updateUser(const std::string& user, const std::string& repeater, const std::string& gateway, const std::string& address, const std::string& timestamp, DSTAR_PROTOCOL protocol, bool addrLock, bool protoLock)
 {
-	mux.lock();
-    CRepeaterRecord *rr = m_repeaterCache.find(repeater);
-	std::string gateway;
-	if (rr == NULL) {
-		gateway = repeater;
-		gateway.resize(LONG_CALLSIGN_LENGTH - 1U, ' ');
-		gateway.push_back('G');
-	} else {
-		gateway = rr->getGateway();
-	}
+	::pthread_rwlock_wrlock(&m_lock);
+	putUser(CCallsign(user), CCallsign(repeater), CCallsign(gateway), address, timestamp, protocol, addrLock, protoLock);
+	::pthread_rwlock_unlock(&m_lock);
+}
+
+void CCacheManager::updateRepeater(const std::string& repeater, const std::string& gateway, const std::string& address, DSTAR_PROTOCOL protocol, bool addrLock, bool protoLock)
+{
+	::pthread_rwlock_wrlock(&m_lock);
+	putRepeater(CCallsign(repeater), CCallsign(gateway), address, protocol, addrLock, protoLock);
+	::pthread_rwlock_unlock(&m_lock);
+}
 
-	CGatewayRecord *gr = m_gatewayCache.find(gateway);
-	if (gr == NULL) {
-		mux.unlock();
-		return NULL;
+void CCacheManager::updateGateway(const std::string& gateway, const std::string& address, DSTAR_PROTOCOL protocol, bool addrLock, bool protoLock)
+{
+	::pthread_rwlock_wrlock(&m_lock);
+	m_gatewayCache.update(CCallsign(gateway), address, protocol, addrLock, protoLock);
+	::pthread_rwlock_unlock(&m_lock);
+}
+
+// The same choices as CSGSThread::processIrcDDB() makes for single replies
+void CCacheManager::update(const std::vector<CIRCDDBReply>& replies, unsigned int count)
+{
+	::pthread_rwlock_wrlock(&m_lock);
+	for (unsigned int i = 0U; i < count; i++) {
+		const CIRCDDBReply &reply = replies[i];
+
+		switch (reply.m_type) {
+			case IDRT_USER:
+				if (reply.m_address.size())
+					putUser(CCallsign(reply.m_user), CCallsign(reply.m_repeater), CCallsign(reply.m_gateway), reply.m_address, reply.m_timeStamp, DP_DEXTRA, false, false);
+				break;
+			case IDRT_REPEATER:
+				if (reply.m_address.size())
+					putRepeater(CCallsign(reply.m_repeater), CCallsign(reply.m_gateway), reply.m_address, DP_DEXTRA, false, false);
+				else
+					putRepeater(CCallsign(reply.m_repeater), CCallsign(reply.m_gateway));
+				break;
+			case IDRT_GATEWAY:
+				if (0 == reply.m_address.size())
+					m_gatewayCache.update(CCallsign(reply.m_gateway), reply.m_address, DP_DEXTRA, false, false);
+				break;
+			default:
+				break;
+		}
 	}
+	::pthread_rwlock_unlock(&m_lock);
+}
+
+void CCacheManager::putUser(const CCallsign& user, const CCallsign& repeater, const CCallsign& gateway, const std::string& address, const std::string& timeStamp, DSTAR_PROTOCOL protocol, bool addrLock, bool protoLock)
+{
+	m_userCache.update(user, repeater, timeStamp);
 
-	CRepeaterData *repeaterdata = new CRepeaterData(repeater, gr->getGateway(), gr->getAddress(), gr->getProtocol());
-	mux.unlock();
-	return repeaterdata;
+	putRepeater(repeater, gateway, address, protocol, addrLock, protoLock);
 }
 
-void CCacheManager::updateUser(const std::string& user, const std::string& repeater, const std::string& gateway, const std::string& address, const std::string& timestamp, DSTAR_PROTOCOL protocol, bool addrLock, bool protoLock)
+void CCacheManager::putRepeater(const CCallsign& repeater, const CCallsign& gateway, const std::string& address, DSTAR_PROTOCOL protocol, bool addrLock, bool protoLock)
 {
-	mux.lock();
-	std::string repeater7 = repeater.substr(0, LONG_CALLSIGN_LENGTH - 1U);
-	std::string gateway7  = gateway.substr(0, LONG_CALLSIGN_LENGTH - 1U);
+	putRepeater(repeater, gateway);
 
-	m_userCache.update(user, repeater, timestamp);
+	m_gatewayCache.update(gateway, address, protocol, addrLock, protoLock);
+}
 
+void CCacheManager::putRepeater(const CCallsign& repeater, const CCallsign& gateway)
+{
 	// Only store non-standard repeater-gateway pairs
-	if (repeater7.compare(gateway7))
+	if (repeater.getBase() != gateway.getBase())
 		m_repeaterCache.update(repeater, gateway);
+}
 
-	m_gatewayCache.update(gateway, address, protocol, addrLock, protoLock);
-	mux.unlock();
+void CCacheManager::setLimits(unsigned int users, unsigned int repeaters, unsigned int gateways, unsigned int ttl)
+{
+	::pthread_rwlock_wrlock(&m_lock);
+	m_userCache.setLimits(users, ttl);
+	m_repeaterCache.setLimits(repeaters);
+	m_gatewayCache.setLimits(gateways);
+	::pthread_rwlock_unlock(&m_lock);
 }
 
-void CCacheManager::updateRepeater(const std::string& repeater, const std::string& gateway, const std::string& address, DSTAR_PROTOCOL protocol, bool addrLock, bool protoLock)
+const char CACHE_SNAPSHOT_MAGIC[] = "SGSC";
+const uint32_t CACHE_SNAPSHOT_VERSION = 1U;
+
+CSnapshotWriter *CCacheManager::save()
 {
-	mux.lock();
-	std::string repeater7 = repeater.substr(0, LONG_CALLSIGN_LENGTH - 1U);
-	std::string gateway7  = gateway.substr(0, LONG_CALLSIGN_LENGTH - 1U);
+	CSnapshotWriter *snapshot = new CSnapshotWriter(CACHE_SNAPSHOT_MAGIC, CACHE_SNAPSHOT_VERSION);
 
-	// Only store non-standard repeater-gateway pairs
-	if (repeater7.compare(gateway7))
-		m_repeaterCache.update(repeater, gateway);
+	::pthread_rwlock_rdlock(&m_lock);
+	m_userCache.save(*snapshot, 0U);
+	m_repeaterCache.save(*snapshot, 1U);
+	m_gatewayCache.save(*snapshot, 2U);
+	::pthread_rwlock_unlock(&m_lock);
 
-	m_gatewayCache.update(gateway, address, protocol, addrLock, protoLock);
-	mux.unlock();
+	return snapshot;
 }
 
-void CCacheManager::updateGateway(const std::string& gateway, const std::string& address, DSTAR_PROTOCOL protocol, bool addrLock, bool protoLock)
+// Call this before the host files are loaded, so that they take precedence
+bool CCacheManager::load(const std::string& fileName)
 {
-	mux.lock();
-	m_gatewayCache.update(gateway, address, protocol, addrLock, protoLock);
-	mux.unlock();
+	CSnapshotReader snapshot;
+	if (!snapshot.open(fileName, CACHE_SNAPSHOT_MAGIC, CACHE_SNAPSHOT_VERSION))
+		return false;
+
+	::pthread_rwlock_wrlock(&m_lock);
+	unsigned int users     = m_userCache.load(snapshot, 0U);
+	unsigned int repeaters = m_repeaterCache.load(snapshot, 1U);
+	unsigned int gateways  = m_gatewayCache.load(snapshot, 2U);
+	::pthread_rwlock_unlock(&m_lock);
+
+	printf("Loaded %u users, %u repeaters and %u gateways from %s\n", users, repeaters, gateways, fileName.c_str());
+	return true;
+}
+
+void CCacheManager::printStats()
+{
+	unsigned long hits, misses, evictions;
+
+	::pthread_rwlock_rdlock(&m_lock);
+	m_userCache.getStats(hits, misses, evictions);
+	printf("Cache: %u users, %lu hits, %lu misses, %lu evicted\n", m_userCache.getCount(), hits, misses, evictions);
+	m_repeaterCache.getStats(hits, misses, evictions);
+	printf("Cache: %u repeaters, %lu hits, %lu misses, %lu evicted\n", m_repeaterCache.getCount(), hits, misses, evictions);
+	m_gatewayCache.getStats(hits, misses, evictions);
+	printf("Cache: %u gateways, %lu hits, %lu misses, %lu evicted\n", m_gatewayCache.getCount(), hits, misses, evictions);
+	::pthread_rwlock_unlock(&m_lock);
+}
+
+void CCacheManager::expire()
+{
+	::pthread_rwlock_wrlock(&m_lock);
+	unsigned int users = m_userCache.expire();
+	::pthread_rwlock_unlock(&m_lock);
+
+	if (users)
+		printf("Cache: %u users timed out\n", users);
 }
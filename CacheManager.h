@@ -19,16 +19,27 @@
 
 #pragma once
 
+#include <pthread.h>
 #include <string>
-#include <mutex>
 
 #include "RepeaterCache.h"
 #include "GatewayCache.h"
 #include "UserCache.h"
+#include "IRCDDB.h"
+
+// The results of the finds are plain values, filled in without allocating
 
 class CUserData {
 public:
-	CUserData(const std::string& user, const std::string& repeater, const std::string& gateway, in_addr address) :
+	CUserData() :
+	m_user(),
+	m_repeater(),
+	m_gateway(),
+	m_address()
+	{
+	}
+
+	CUserData(const CCallsign& user, const CCallsign& repeater, const CCallsign& gateway, in_addr address) :
 	m_user(user),
 	m_repeater(repeater),
 	m_gateway(gateway),
@@ -38,17 +49,17 @@ public:
 
 	std::string getUser() const
 	{
-		return m_user;
+		return m_user.getString();
 	}
 
 	std::string getRepeater() const
 	{
-		return m_repeater;
+		return m_repeater.getString();
 	}
 
 	std::string getGateway() const
 	{
-		return m_gateway;
+		return m_gateway.getString();
 	}
 
 	in_addr getAddress() const
@@ -57,15 +68,23 @@ public:
 	}
 
 private:
-	std::string m_user;
-	std::string m_repeater;
-	std::string m_gateway;
-	in_addr  m_address;
+	CCallsign m_user;
+	CCallsign m_repeater;
+	CCallsign m_gateway;
+	in_addr   m_address;
 };
 
 class CRepeaterData {
 public:
-	CRepeaterData(const std::string& repeater, const std::string& gateway, in_addr address, DSTAR_PROTOCOL protocol) :
+	CRepeaterData() :
+	m_repeater(),
+	m_gateway(),
+	m_address(),
+	m_protocol(DP_UNKNOWN)
+	{
+	}
+
+	CRepeaterData(const CCallsign& repeater, const CCallsign& gateway, in_addr address, DSTAR_PROTOCOL protocol) :
 	m_repeater(repeater),
 	m_gateway(gateway),
 	m_address(address),
@@ -75,12 +94,12 @@ public:
 
 	std::string getRepeater() const
 	{
-		return m_repeater;
+		return m_repeater.getString();
 	}
 
 	std::string getGateway() const
 	{
-		return m_gateway;
+		return m_gateway.getString();
 	}
 
 	in_addr getAddress() const
@@ -94,15 +113,22 @@ public:
 	}
 
 private:
-	std::string    m_repeater;
-	std::string    m_gateway;
+	CCallsign      m_repeater;
+	CCallsign      m_gateway;
 	in_addr        m_address;
 	DSTAR_PROTOCOL m_protocol;
 };
 
 class CGatewayData {
 public:
-	CGatewayData(const std::string& gateway, in_addr address, DSTAR_PROTOCOL protocol) :
+	CGatewayData() :
+	m_gateway(),
+	m_address(),
+	m_protocol(DP_UNKNOWN)
+	{
+	}
+
+	CGatewayData(const CCallsign& gateway, in_addr address, DSTAR_PROTOCOL protocol) :
 	m_gateway(gateway),
 	m_address(address),
 	m_protocol(protocol)
@@ -111,7 +137,7 @@ public:
 
 	std::string getGateway() const
 	{
-		return m_gateway;
+		return m_gateway.getString();
 	}
 
 	in_addr getAddress() const
@@ -125,27 +151,50 @@ public:
 	}
 
 private:
-	std::string    m_gateway;
+	CCallsign      m_gateway;
 	in_addr        m_address;
 	DSTAR_PROTOCOL m_protocol;
 };
 
+// The finds may be called from any number of threads at once, they share a
+// read lock and only wait while an update is being made.
 class CCacheManager {
 public:
 	CCacheManager();
 	~CCacheManager();
 
-	CUserData*     findUser(const std::string& user);
-	CGatewayData*  findGateway(const std::string& gateway);
-	CRepeaterData* findRepeater(const std::string& repeater);
+	// false if it isn't known, data is only changed when it is
+	bool findUser(const std::string& user, CUserData& data);
+	bool findGateway(const std::string& gateway, CGatewayData& data);
+	bool findRepeater(const std::string& repeater, CRepeaterData& data);
 
 	void updateUser(const std::string& user, const std::string& repeater, const std::string& gateway, const std::string& address, const std::string& timeStamp, DSTAR_PROTOCOL protocol, bool addrLock, bool protoLock);
 	void updateRepeater(const std::string& repeater, const std::string& gateway, const std::string& address, DSTAR_PROTOCOL protocol, bool addrLock, bool protoLock);
 	void updateGateway(const std::string& gateway, const std::string& address, DSTAR_PROTOCOL protocol, bool addrLock, bool protoLock);
 
+	// The first count replies from ircDDB, all under one lock
+	void update(const std::vector<CIRCDDBReply>& replies, unsigned int count);
+
+	// ttl is in seconds and only applies to users, repeaters and gateways don't time out
+	void setLimits(unsigned int users, unsigned int repeaters, unsigned int gateways, unsigned int ttl);
+	void printStats();
+
+	// Drop the users that have timed out
+	void expire();
+
+	// Warm restart snapshot of everything learnt from ircDDB. save() only
+	// copies the caches, the caller writes the snapshot out and deletes it.
+	CSnapshotWriter *save();
+	bool load(const std::string& fileName);
+
 private:
 	CUserCache     m_userCache;
 	CGatewayCache  m_gatewayCache;
 	CRepeaterCache m_repeaterCache;
-	std::mutex mux;
+	pthread_rwlock_t m_lock;
+
+	// These need m_lock to be held for writing
+	void putUser(const CCallsign& user, const CCallsign& repeater, const CCallsign& gateway, const std::string& address, const std::string& timeStamp, DSTAR_PROTOCOL protocol, bool addrLock, bool protoLock);
+	void putRepeater(const CCallsign& repeater, const CCallsign& gateway, const std::string& address, DSTAR_PROTOCOL protocol, bool addrLock, bool protoLock);
+	void putRepeater(const CCallsign& repeater, const CCallsign& gateway);
 };
@@ -0,0 +1,136 @@
+/*
+ *   Copyright (c) 2018 by Thomas A. Early N7TAE
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation; either version 2 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+
+
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <string>
+
+// An 8 character D-Star callsign packed into a 64-bit word, first character
+// in the top byte, so that it compares the same way as the padded string.
+class CCallsign {
+public:
+	constexpr CCallsign() :
+	m_value(SPACES)
+	{
+	}
+
+	// Longer strings are cut to 8 characters, shorter ones are padded with spaces
+	explicit CCallsign(const std::string &callsign) :
+	m_value(pack(callsign.data(), callsign.size()))
+	{
+	}
+
+	explicit CCallsign(const char *callsign, unsigned int length = 8U) :
+	m_value(pack(callsign, length))
+	{
+	}
+
+	// For records read back from a file
+	static constexpr CCallsign fromValue(uint64_t value)
+	{
+		return CCallsign(value);
+	}
+
+	std::string getString() const
+	{
+		std::string callsign(8U, ' ');
+		for (unsigned int i = 0U; i < 8U; i++)
+			callsign[i] = char(m_value >> (56U - 8U * i));
+		return callsign;
+	}
+
+	constexpr uint64_t getValue() const
+	{
+		return m_value;
+	}
+
+	constexpr bool isBlank() const
+	{
+		return m_value == SPACES;
+	}
+
+	// The band or module letter in the last position
+	constexpr char getModule() const
+	{
+		return char(m_value & 0xFFU);
+	}
+
+	constexpr CCallsign setModule(char module) const
+	{
+		return CCallsign((m_value & ~uint64_t(0xFFU)) | uint8_t(module));
+	}
+
+	// The callsign with a space in the last position
+	constexpr CCallsign getBase() const
+	{
+		return setModule(' ');
+	}
+
+	// The gateway of a repeater, "N7TAE  C" becomes "N7TAE  G"
+	constexpr CCallsign getGateway() const
+	{
+		return setModule('G');
+	}
+
+	constexpr bool operator==(const CCallsign &other) const
+	{
+		return m_value == other.m_value;
+	}
+
+	constexpr bool operator!=(const CCallsign &other) const
+	{
+		return m_value != other.m_value;
+	}
+
+	constexpr bool operator<(const CCallsign &other) const
+	{
+		return m_value < other.m_value;
+	}
+
+private:
+	static constexpr uint64_t SPACES = 0x2020202020202020ULL;
+
+	uint64_t m_value;
+
+	constexpr explicit CCallsign(uint64_t value) :
+	m_value(value)
+	{
+	}
+
+	static uint64_t pack(const char *callsign, unsigned int length)
+	{
+		uint64_t value = SPACES;
+		for (unsigned int i = 0U; i < length && i < 8U; i++)
+			value = (value & ~(uint64_t(0xFFU) << (56U - 8U * i))) | (uint64_t(uint8_t(callsign[i])) << (56U - 8U * i));
+		return value;
+	}
+};
+
+namespace std {
+	template<> struct hash<CCallsign> {
+		size_t operator()(const CCallsign &callsign) const
+		{
+			// callsigns mostly differ in the middle, so spread those bits
+			uint64_t value = callsign.getValue() * 0x9E3779B97F4A7C15ULL;
+			return size_t(value ^ (value >> 32));
+		}
+	};
+}
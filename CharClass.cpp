@@ -0,0 +1,124 @@
+/*
+ *   Copyright (c) 2018 by Thomas A. Early N7TAE
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation; either version 2 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+
+
+#include <cstring>
+
+#include "CharClass.h"
+
+class CCharClassTable {
+public:
+	CCharClassTable()
+	{
+		::memset(m_tab, 0x00U, sizeof(m_tab));
+
+		for (unsigned int c = '0'; c <= '9'; c++)
+			m_tab[c] |= CC_DIGIT | CC_DBKEY | CC_CALLSIGN | CC_QTH;
+
+		for (unsigned int c = 'A'; c <= 'Z'; c++) {
+			m_tab[c]        |= CC_DBKEY | CC_CALLSIGN | CC_QTH;
+			m_tab[c + 32U]  |= CC_QTH;		// a-z
+		}
+
+		m_tab[(unsigned char)'_'] |= CC_DBKEY | CC_CALLSIGN;
+		m_tab[(unsigned char)'/'] |= CC_CALLSIGN;
+
+		const char *qth = " +&(),./'-";
+		for (const char *p = qth; *p; p++)
+			m_tab[(unsigned char)*p] |= CC_QTH;
+
+		for (unsigned int c = 0x21U; c <= 0x7EU; c++)
+			m_tab[c] |= CC_GRAPH;
+	}
+
+	unsigned char m_tab[256U];
+};
+
+static const CCharClassTable charClassTab;
+
+const unsigned char *CCharClass::m_table = charClassTab.m_tab;
+
+bool CCharClass::all(const std::string &str, unsigned char cls)
+{
+	for (auto it = str.begin(); it != str.end(); ++it) {
+		if (!is(*it, cls))
+			return false;
+	}
+
+	return true;
+}
+
+void CCharClass::replace(std::string &str, unsigned char cls, char with)
+{
+	for (auto it = str.begin(); it != str.end(); ++it) {
+		if (!is(*it, cls))
+			*it = with;
+	}
+}
+
+void CCharClass::remove(std::string &str, unsigned char cls)
+{
+	std::string::iterator out = str.begin();
+	for (auto it = str.begin(); it != str.end(); ++it) {
+		if (is(*it, cls))
+			*out++ = *it;
+	}
+	str.erase(out, str.end());
+}
+
+// ^[0-9]$
+bool CCharClass::isTableID(const std::string &s)
+{
+	return 1U == s.size() && is(s[0], CC_DIGIT);
+}
+
+// ^[0-9A-Z_]{8}$
+bool CCharClass::isDBKey(const std::string &s)
+{
+	return 8U == s.size() && all(s, CC_DBKEY);
+}
+
+int CCharClass::twoDigits(const std::string &s, unsigned int pos)
+{
+	if (!is(s[pos], CC_DIGIT) || !is(s[pos + 1U], CC_DIGIT))
+		return -1;
+	return (s[pos] - '0') * 10 + (s[pos + 1U] - '0');
+}
+
+// ^20[0-9][0-9]-(0[1-9]|1[0-2])-(0[1-9]|[12][0-9]|3[01])$
+bool CCharClass::isDate(const std::string &s)
+{
+	if (10U != s.size() || '2' != s[0] || '0' != s[1] || '-' != s[4] || '-' != s[7])
+		return false;
+
+	int month = twoDigits(s, 5U);
+	int day   = twoDigits(s, 8U);
+	return twoDigits(s, 2U) >= 0 && month >= 1 && month <= 12 && day >= 1 && day <= 31;
+}
+
+// ^([01][0-9]|2[0-3]):[0-5][0-9]:[0-5][0-9]$
+bool CCharClass::isTime(const std::string &s)
+{
+	if (8U != s.size() || ':' != s[2] || ':' != s[5])
+		return false;
+
+	int hour   = twoDigits(s, 0U);
+	int minute = twoDigits(s, 3U);
+	int second = twoDigits(s, 6U);
+	return hour >= 0 && hour <= 23 && minute >= 0 && minute <= 59 && second >= 0 && second <= 59;
+}
@@ -0,0 +1,58 @@
+/*
+ *   Copyright (c) 2018 by Thomas A. Early N7TAE
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation; either version 2 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+
+
+#pragma once
+
+#include <string>
+
+// Character classes for checking and cleaning ircDDB fields, one bit each
+const unsigned char CC_DIGIT    = 0x01U;	// 0-9
+const unsigned char CC_DBKEY    = 0x02U;	// 0-9 A-Z _, the keys of the ircDDB tables
+const unsigned char CC_CALLSIGN = 0x04U;	// 0-9 A-Z _ /, heard reports
+const unsigned char CC_QTH      = 0x08U;	// the QTH description text
+const unsigned char CC_GRAPH    = 0x10U;	// printable, except for space
+
+// A 256 entry lookup table replaces the std::regex character classes
+class CCharClass {
+public:
+	static bool is(char c, unsigned char cls)
+	{
+		return (m_table[(unsigned char)c] & cls) != 0U;
+	}
+
+	// true if every character is in the class
+	static bool all(const std::string &str, unsigned char cls);
+
+	// Replace every character that isn't in the class
+	static void replace(std::string &str, unsigned char cls, char with);
+
+	// Remove every character that isn't in the class
+	static void remove(std::string &str, unsigned char cls);
+
+	// Fixed format checks for the fields of the ircDDB table lines
+	static bool isTableID(const std::string &str);
+	static bool isDBKey(const std::string &str);
+	static bool isDate(const std::string &str);
+	static bool isTime(const std::string &str);
+
+private:
+	static int twoDigits(const std::string &str, unsigned int pos);
+
+	static const unsigned char *m_table;
+};
@@ -18,6 +18,7 @@
  */
 
 #include <cassert>
+#include <ctime>
 
 #include "DCSHandler.h"
 #include "Utils.h"
@@ -32,6 +33,7 @@ GATEWAY_TYPE             CDCSHandler::m_gatewayType  = GT_REPEATER;
 CCallsignList           *CDCSHandler::m_whiteList = NULL;
 CCallsignList           *CDCSHandler::m_blackList = NULL;
 std::list<CDCSHandler *> CDCSHandler::m_DCSHandlers;
+std::unordered_multimap<uint64_t, CDCSHandler *> CDCSHandler::m_index;
 
 
 CDCSHandler::CDCSHandler(IReflectorCallback *handler, const std::string &dcsHandler, const std::string &repeater, CDCSProtocolHandler *protoHandler, const in_addr &address, unsigned int port, DIRECTION direction) :
@@ -45,25 +47,22 @@ m_direction(direction),
 m_linkState(DCS_LINKING),
 m_destination(handler),
 m_time(),
-m_pollTimer(1000U, 5U),
-m_pollInactivityTimer(1000U, 60U),
-m_tryTimer(1000U, 1U),
+m_pollTimer(this, 5U),
+m_pollInactivityTimer(this, 60U),
+m_tryTimer(this, 1U),
 m_tryCount(0U),
 m_dcsId(0x00U),
 m_dcsSeq(0x00U),
 m_seqNo(0x00U),
-m_inactivityTimer(1000U, NETWORK_TIMEOUT),
-m_yourCall(),
-m_myCall1(),
-m_myCall2(),
-m_rptCall1(),
-m_rptCall2()
+m_inactivityTimer(this, NETWORK_TIMEOUT),
+m_header()
 {
 	assert(protoHandler != NULL);
 	assert(handler != NULL);
 	assert(port > 0U);
 
 	m_myPort = protoHandler->getPort();
+	addIndex();
 
 	m_pollInactivityTimer.start();
 
@@ -81,6 +80,8 @@ m_rptCall2()
 
 CDCSHandler::~CDCSHandler()
 {
+	removeIndex();
+
 	if (m_direction == DIR_OUTGOING)
 		m_pool->release(m_handler);
 }
@@ -151,40 +152,25 @@ void CDCSHandler::getInfo(IReflectorCallback *handler, CRemoteRepeaterData &data
 	}
 }
 
-void CDCSHandler::process(CAMBEData &data)
+void CDCSHandler::process(CHeaderData &header, CAMBEData &data)
 {
-	in_addr   yourAddress = data.getYourAddress();
-	unsigned int yourPort = data.getYourPort();
-	unsigned int myPort   = data.getMyPort();
-
-	for (auto it=m_DCSHandlers.begin(); it!=m_DCSHandlers.end(); it++) {
-		CDCSHandler *dcsHandler = *it;
-		if (		dcsHandler->m_yourAddress.s_addr == yourAddress.s_addr &&
-					dcsHandler->m_yourPort           == yourPort &&
-					dcsHandler->m_myPort             == myPort) {
-			dcsHandler->processInt(data);
-			return;
-		}
-	}
+	auto it = m_index.find(makeKey(data.getYourAddress(), data.getYourPort(), data.getMyPort()));
+	if (m_index.end() != it)
+		it->second->processInt(header, data);
 }
 
 void CDCSHandler::process(CPollData &poll)
 {
 	std::string   dcsHandler  = poll.getData1();
 	std::string   repeater   = poll.getData2();
-	in_addr   yourAddress = poll.getYourAddress();
-	unsigned int yourPort = poll.getYourPort();
-	unsigned int   myPort = poll.getMyPort();
 	unsigned int   length = poll.getLength();
 
 	// Check to see if we already have a link
-	for (auto it=m_DCSHandlers.begin(); it!=m_DCSHandlers.end(); it++) {
-		CDCSHandler *handler = *it;
+	auto range = m_index.equal_range(makeKey(poll.getYourAddress(), poll.getYourPort(), poll.getMyPort()));
+	for (auto it=range.first; it!=range.second; it++) {
+		CDCSHandler *handler = it->second;
 		if (		0==handler->m_reflector.compare(dcsHandler) &&
 					0==handler->m_repeater.compare(repeater) &&
-					handler->m_yourAddress.s_addr == yourAddress.s_addr &&
-					handler->m_yourPort  == yourPort &&
-					handler->m_myPort    == myPort &&
 					handler->m_direction == DIR_OUTGOING &&
 					handler->m_linkState == DCS_LINKED &&
 					length == 22U) {
@@ -193,9 +179,6 @@ void CDCSHandler::process(CPollData &poll)
 			handler->m_handler->writePoll(reply);
 			return;
 		} else if (0==handler->m_reflector.compare(0, LONG_CALLSIGN_LENGTH - 1U, dcsHandler, 0, LONG_CALLSIGN_LENGTH - 1U) &&
-				   handler->m_yourAddress.s_addr == yourAddress.s_addr &&
-				   handler->m_yourPort  == yourPort &&
-				   handler->m_myPort    == myPort &&
 				   handler->m_direction == DIR_INCOMING &&
 				   handler->m_linkState == DCS_LINKED &&
 				   length == 17U) {
@@ -364,7 +347,9 @@ void CDCSHandler::gatewayUpdate(const std::string &dcsHandler, const std::string
 			if (address.size()) {
 				// A new address, change the value
 				printf("Changing IP address of DCS gateway or dcsHandler %s to %s\n", dcsHandler->m_reflector.c_str(), address.c_str());
+				dcsHandler->removeIndex();
 				dcsHandler->m_yourAddress.s_addr = ::inet_addr(address.c_str());
+				dcsHandler->addIndex();
 			} else {
 				printf("IP address for DCS gateway or dcsHandler %s has been removed\n", dcsHandler->m_reflector.c_str());
 
@@ -382,16 +367,24 @@ void CDCSHandler::gatewayUpdate(const std::string &dcsHandler, const std::string
 	}
 }
 
-void CDCSHandler::clock(unsigned int ms)
+uint64_t CDCSHandler::makeKey(const in_addr &address, unsigned int yourPort, unsigned int myPort)
 {
-	for (auto it=m_DCSHandlers.begin(); it!=m_DCSHandlers.end(); ) {
-		CDCSHandler *handler = *it;
-		bool ret = handler->clockInt(ms);
-		if (ret) {
-			delete handler;
-			it = m_DCSHandlers.erase(it);
-		} else
-			it++;
+	return (uint64_t(address.s_addr) << 32) | (uint64_t(yourPort & 0xFFFFU) << 16) | uint64_t(myPort & 0xFFFFU);
+}
+
+void CDCSHandler::addIndex()
+{
+	m_index.insert(std::make_pair(makeKey(m_yourAddress, m_yourPort, m_myPort), this));
+}
+
+void CDCSHandler::removeIndex()
+{
+	auto range = m_index.equal_range(makeKey(m_yourAddress, m_yourPort, m_myPort));
+	for (auto it=range.first; it!=range.second; it++) {
+		if (it->second == this) {
+			m_index.erase(it);
+			return;
+		}
 	}
 }
 
@@ -404,13 +397,13 @@ void CDCSHandler::finalise()
 	}
 }
 
-void CDCSHandler::processInt(CAMBEData &data)
+void CDCSHandler::processInt(CHeaderData &hdr, CAMBEData &data)
 {
-	// Make a copy of the AMBE data so that any changes made here don't modify the original
+	// Make a copy of the header and the AMBE data so that any changes made here don't modify the original
+	CHeaderData header(hdr);
 	CAMBEData temp(data);
 
 	unsigned int id = temp.getId();
-	CHeaderData& header = temp.getHeader();
 	unsigned int seqNo = temp.getSeq();
 
 	std::string   my = header.getMyCall1();
@@ -596,14 +589,9 @@ bool CDCSHandler::processInt(CConnectData &connect, CD_TYPE type)
 	}
 }
 
-bool CDCSHandler::clockInt(unsigned int ms)
+void CDCSHandler::timerExpired(CWheelTimer &timer)
 {
-	m_pollInactivityTimer.clock(ms);
-	m_inactivityTimer.clock(ms);
-	m_pollTimer.clock(ms);
-	m_tryTimer.clock(ms);
-
-	if (m_pollInactivityTimer.isRunning() && m_pollInactivityTimer.hasExpired()) {
+	if (&timer == &m_pollInactivityTimer) {
 		m_pollInactivityTimer.start();
 
 		m_stateChange = true;
@@ -632,38 +620,29 @@ bool CDCSHandler::clockInt(unsigned int ms)
 				m_linkState = DCS_LINKING;
 				m_tryTimer.start(1U);
 				m_tryCount = 0U;
-				return false;
+				return;
 			}
 		}
 
-		return true;
-	}
-
-	if (m_inactivityTimer.isRunning() && m_inactivityTimer.hasExpired()) {
+		// this link is dead
+		m_DCSHandlers.remove(this);
+		delete this;
+	} else if (&timer == &m_inactivityTimer) {
 		m_dcsId  = 0x00U;
 		m_dcsSeq = 0x00U;
-		m_inactivityTimer.stop();
-	}
-
-	if (m_pollTimer.isRunning() && m_pollTimer.hasExpired()) {
+	} else if (&timer == &m_pollTimer) {
 		m_pollTimer.start();
 
 		CPollData poll(m_repeater, m_reflector, m_direction, m_yourAddress, m_yourPort);
 		m_handler->writePoll(poll);
-	}
-
-	if (m_linkState == DCS_LINKING) {
-		if (m_tryTimer.isRunning() && m_tryTimer.hasExpired()) {
+	} else if (&timer == &m_tryTimer) {
+		if (m_linkState == DCS_LINKING) {
 			CConnectData reply(m_gatewayType, m_repeater, m_reflector, CT_LINK1, m_yourAddress, m_yourPort);
 			m_handler->writeConnect(reply);
 
 			unsigned int timeout = calcBackoff();
 			m_tryTimer.start(timeout);
-		}
-	}
-
-	if (m_linkState == DCS_UNLINKING) {
-		if (m_tryTimer.isRunning() && m_tryTimer.hasExpired()) {
+		} else if (m_linkState == DCS_UNLINKING) {
 			CConnectData connect(m_repeater, m_reflector, CT_UNLINK, m_yourAddress, m_yourPort);
 			m_handler->writeConnect(connect);
 
@@ -671,8 +650,6 @@ bool CDCSHandler::clockInt(unsigned int ms)
 			m_tryTimer.start(timeout);
 		}
 	}
-
-	return false;
 }
 
 void CDCSHandler::writeHeaderInt(IReflectorCallback *handler, CHeaderData& header, DIRECTION direction)
@@ -693,11 +670,9 @@ void CDCSHandler::writeHeaderInt(IReflectorCallback *handler, CHeaderData& heade
 
 	m_seqNo    = 0U;
 
-	m_myCall1  = header.getMyCall1();
-	m_myCall2  = header.getMyCall2();
-	m_yourCall = header.getYourCall();
-	m_rptCall1 = header.getRptCall1();
-	m_rptCall2 = header.getRptCall2();
+	// This is the header context for every frame of the stream
+	m_header   = header;
+	m_header.setCQCQCQ();
 }
 
 void CDCSHandler::writeAMBEInt(IReflectorCallback *handler, CAMBEData &data, DIRECTION direction)
@@ -716,16 +691,9 @@ void CDCSHandler::writeAMBEInt(IReflectorCallback *handler, CAMBEData &data, DIR
 	if (m_dcsId != 0x00)
 		return;
 
-	CHeaderData& header = data.getHeader();
-	header.setMyCall1(m_myCall1);
-	header.setMyCall2(m_myCall2);
-	header.setRptCall1(m_rptCall1);
-	header.setRptCall2(m_rptCall2);
-	header.setCQCQCQ();
-
 	data.setRptSeq(m_seqNo++);
 	data.setDestination(m_yourAddress, m_yourPort);
-	m_handler->writeData(data);
+	m_handler->writeData(m_header, data);
 }
 
 bool CDCSHandler::stateChange()
@@ -23,6 +23,8 @@
 #include <string>
 #include <cstdio>
 #include <list>
+#include <unordered_map>
+#include <cstdint>
 
 #include "DCSProtocolHandlerPool.h"
 #include "RemoteRepeaterData.h"
@@ -31,8 +33,8 @@
 #include "CallsignList.h"
 #include "ConnectData.h"
 #include "AMBEData.h"
+#include "TimerWheel.h"
 #include "PollData.h"
-#include "Timer.h"
 #include "Defs.h"
 
 enum DCS_STATE {
@@ -41,7 +43,7 @@ enum DCS_STATE {
 	DCS_UNLINKING
 };
 
-class CDCSHandler {
+class CDCSHandler : public ITimerCallback {
 public:
 	static void setDCSProtocolHandlerPool(CDCSProtocolHandlerPool *pool);
 	static void setDCSProtocolIncoming(CDCSProtocolHandler *handler);
@@ -55,12 +57,11 @@ public:
 	static void writeHeader(IReflectorCallback *handler, CHeaderData &header, DIRECTION direction);
 	static void writeAMBE(IReflectorCallback *handler, CAMBEData &data, DIRECTION direction);
 
-	static void process(CAMBEData &header);
+	static void process(CHeaderData &header, CAMBEData &data);
 	static void process(CPollData &data);
 	static void process(CConnectData &connect);
 
 	static void gatewayUpdate(const std::string &reflector, const std::string &address);
-	static void clock(unsigned int ms);
 
 	static bool stateChange();
 	static void writeStatus(FILE *file);
@@ -78,16 +79,18 @@ protected:
 	CDCSHandler(IReflectorCallback *handler, const std::string &reflector, const std::string &repeater, CDCSProtocolHandler *protoHandler, const in_addr &address, unsigned int port, DIRECTION direction);
 	~CDCSHandler();
 
-	void processInt(CAMBEData &data);
+	void processInt(CHeaderData &header, CAMBEData &data);
 	bool processInt(CConnectData &connect, CD_TYPE type);
 
 	void writeHeaderInt(IReflectorCallback *handler, CHeaderData &header, DIRECTION direction);
 	void writeAMBEInt(IReflectorCallback *handler, CAMBEData &data, DIRECTION direction);
 
-	bool clockInt(unsigned int ms);
+	virtual void timerExpired(CWheelTimer &timer);
 
 private:
 	static std::list<CDCSHandler *> m_DCSHandlers;
+	// The same links, by remote address, remote port and local port
+	static std::unordered_multimap<uint64_t, CDCSHandler *> m_index;
 
 	static CDCSProtocolHandlerPool *m_pool;
 	static CDCSProtocolHandler     *m_incoming;
@@ -109,21 +112,21 @@ private:
 	DCS_STATE            m_linkState;
 	IReflectorCallback  *m_destination;
 	time_t               m_time;
-	CTimer               m_pollTimer;
-	CTimer               m_pollInactivityTimer;
-	CTimer               m_tryTimer;
+	CWheelTimer          m_pollTimer;
+	CWheelTimer          m_pollInactivityTimer;
+	CWheelTimer          m_tryTimer;
 	unsigned int         m_tryCount;
 	unsigned int         m_dcsId;
 	unsigned int         m_dcsSeq;
 	unsigned int         m_seqNo;
-	CTimer               m_inactivityTimer;
+	CWheelTimer          m_inactivityTimer;
 
 	// Header data
-	std::string             m_yourCall;
-	std::string             m_myCall1;
-	std::string             m_myCall2;
-	std::string             m_rptCall1;
-	std::string             m_rptCall2;
+	CHeaderData             m_header;		// of the stream we are sending
 
 	unsigned int calcBackoff();
+
+	static uint64_t makeKey(const in_addr &address, unsigned int yourPort, unsigned int myPort);
+	void addIndex();
+	void removeIndex();
 };
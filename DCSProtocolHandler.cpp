@@ -22,8 +22,6 @@
 
 // #define	DUMP_TX
 
-const unsigned int BUFFER_LENGTH = 2000U;
-
 CDCSProtocolHandler::CDCSProtocolHandler(unsigned int port, const std::string& addr) :
 m_socket(addr, port),
 m_type(DC_NONE),
@@ -33,12 +31,10 @@ m_yourAddress(),
 m_yourPort(0U),
 m_myPort(port)
 {
-	m_buffer = new unsigned char[BUFFER_LENGTH];
 }
 
 CDCSProtocolHandler::~CDCSProtocolHandler()
 {
-	delete[] m_buffer;
 }
 
 bool CDCSProtocolHandler::open()
@@ -51,10 +47,15 @@ unsigned int CDCSProtocolHandler::getPort() const
 	return m_myPort;
 }
 
-bool CDCSProtocolHandler::writeData(const CAMBEData& data)
+int CDCSProtocolHandler::getFD() const
+{
+	return m_socket.getFD();
+}
+
+bool CDCSProtocolHandler::writeData(const CHeaderData& header, const CAMBEData& data)
 {
 	unsigned char buffer[100U];
-	unsigned int length = data.getDCSData(buffer, 100U);
+	unsigned int length = data.getDCSData(header, buffer, 100U);
 
 #if defined(DUMP_TX)
 	CUtils::dump("Sending Data", buffer, length);
@@ -103,7 +104,7 @@ bool CDCSProtocolHandler::readPackets()
 	m_type = DC_NONE;
 
 	// No more data?
-	int length = m_socket.read(m_buffer, BUFFER_LENGTH, m_yourAddress, m_yourPort);
+	int length = m_socket.readNext(m_buffer, m_yourAddress, m_yourPort);
 	if (length <= 0)
 		return false;
 
@@ -141,20 +142,15 @@ bool CDCSProtocolHandler::readPackets()
 	return true;
 }
 
-CAMBEData* CDCSProtocolHandler::readData()
+// Every DCS frame carries the header of its stream as well
+bool CDCSProtocolHandler::readData(CHeaderData& header, CAMBEData& data)
 {
 	if (m_type != DC_DATA)
-		return NULL;
-
-	CAMBEData* data = new CAMBEData;
+		return false;
 
-	bool res = data->setDCSData(m_buffer, m_length, m_yourAddress, m_yourPort, m_myPort);
-	if (!res) {
-		delete data;
-		return NULL;
-	}
+	header.setDCSData(m_buffer, m_length, m_yourAddress, m_yourPort, m_myPort);
 
-	return data;
+	return data.setDCSData(m_buffer, m_length, m_yourAddress, m_yourPort, m_myPort);
 }
 
 CPollData* CDCSProtocolHandler::readPoll()
@@ -43,13 +43,14 @@ public:
 	bool open();
 
 	unsigned int getPort() const;
+	int          getFD() const;
 
-	bool writeData(const CAMBEData& data);
+	bool writeData(const CHeaderData& header, const CAMBEData& data);
 	bool writeConnect(const CConnectData& connect);
 	bool writePoll(const CPollData& poll);
 
 	DCS_TYPE      read();
-	CAMBEData*    readData();
+	bool          readData(CHeaderData& header, CAMBEData& data);
 	CPollData*    readPoll();
 	CConnectData* readConnect();
 
@@ -58,7 +59,7 @@ public:
 private:
 	CUDPReaderWriter m_socket;
 	DCS_TYPE         m_type;
-	unsigned char*   m_buffer;
+	const unsigned char*   m_buffer;
 	unsigned int     m_length;
 	in_addr          m_yourAddress;
 	unsigned int     m_yourPort;
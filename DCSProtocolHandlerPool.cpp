@@ -24,7 +24,8 @@
 
 CDCSProtocolHandlerPool::CDCSProtocolHandlerPool(const unsigned int port, const std::string &addr) :
 m_basePort(port),
-m_address(addr)
+m_address(addr),
+m_epoll(NULL)
 {
 	assert(port > 0U);
 	m_index = m_pool.end();
@@ -49,6 +50,8 @@ CDCSProtocolHandler *CDCSProtocolHandlerPool::getHandler()
 	if (proto) {
 		if (proto->open()) {
 			m_pool[port] = proto;
+			if (m_epoll)
+				m_epoll->add(proto->getFD(), ES_DCS, port);
 			printf("New CDCSProtocolHandler now on port %u.\n", port);
 		} else {
 			delete proto;
@@ -65,6 +68,10 @@ void CDCSProtocolHandlerPool::release(CDCSProtocolHandler *handler)
 	assert(handler != NULL);
 	for (auto it=m_pool.begin(); it!=m_pool.end(); it++) {
 		if (it->second == handler) {
+			if (m_index == it)
+				m_index = m_pool.end();
+			if (m_epoll)
+				m_epoll->remove(it->second->getFD());
 			it->second->close();
 			delete it->second;
 			printf("Releasing CDCSProtocolHandler on port %u.\n", it->first);
@@ -76,22 +83,25 @@ void CDCSProtocolHandlerPool::release(CDCSProtocolHandler *handler)
 	printf("ERROR: could not find CDCSProtocolHander (port=%u) to release!\n", handler->getPort());
 }
 
-DCS_TYPE CDCSProtocolHandlerPool::read()
+void CDCSProtocolHandlerPool::setEpoll(CEpoll *epoll)
 {
+	assert(epoll != NULL);
+
+	m_epoll = epoll;
+}
+
+// read only the handler bound to this port, after epoll has reported it as readable
+DCS_TYPE CDCSProtocolHandlerPool::read(unsigned int port)
+{
+	m_index = m_pool.find(port);
 	if (m_index == m_pool.end())
-		m_index = m_pool.begin();
-	while (m_index != m_pool.end()) {
-		DCS_TYPE type = m_index->second->read();
-		if (type != DC_NONE)
-			return type;
-		m_index++;
-	}
-	return DC_NONE;
+		return DC_NONE;
+	return m_index->second->read();
 }
 
-CAMBEData *CDCSProtocolHandlerPool::readData()
+bool CDCSProtocolHandlerPool::readData(CHeaderData &header, CAMBEData &data)
 {
-	return m_index->second->readData();
+	return m_index->second->readData(header, data);
 }
 
 CPollData *CDCSProtocolHandlerPool::readPoll()
@@ -23,6 +23,7 @@
 #include <map>
 
 #include "DCSProtocolHandler.h"
+#include "Epoll.h"
 
 class CDCSProtocolHandlerPool {
 public:
@@ -32,8 +33,10 @@ public:
 	CDCSProtocolHandler *getHandler();
 	void release(CDCSProtocolHandler *handler);
 
-	DCS_TYPE      read();
-	CAMBEData    *readData();
+	void setEpoll(CEpoll *epoll);
+
+	DCS_TYPE      read(unsigned int port);
+	bool          readData(CHeaderData &header, CAMBEData &data);
 	CPollData    *readPoll();
 	CConnectData *readConnect();
 
@@ -44,5 +47,6 @@ private:
 	std::map<int,CDCSProtocolHandler *>::iterator m_index;
 	unsigned int m_basePort;
 	std::string m_address;
+	CEpoll     *m_epoll;
 };
 
@@ -18,11 +18,13 @@
  */
 
 #include <cassert>
+#include <ctime>
 
 #include "DExtraHandler.h"
 #include "Utils.h"
 
 std::list<CDExtraHandler *> CDExtraHandler::m_DExtraHandlers;
+std::unordered_multimap<uint64_t, CDExtraHandler *> CDExtraHandler::m_index;
 
 std::string                 CDExtraHandler::m_callsign;
 CDExtraProtocolHandlerPool *CDExtraHandler::m_pool = NULL;
@@ -39,23 +41,27 @@ m_repeater(repeater),
 m_handler(protoHandler),
 m_yourAddress(address),
 m_yourPort(port),
+m_myPort(0U),
 m_direction(direction),
 m_linkState(DEXTRA_LINKING),
 m_destination(handler),
 m_time(),
-m_pollTimer(1000U, 10U),
-m_pollInactivityTimer(1000U, 60U),
-m_tryTimer(1000U, 1U),
+m_pollTimer(this, 10U),
+m_pollInactivityTimer(this, 60U),
+m_tryTimer(this, 1U),
 m_tryCount(0U),
 m_dExtraId(0x00U),
 m_dExtraSeq(0x00U),
-m_inactivityTimer(1000U, NETWORK_TIMEOUT),
+m_inactivityTimer(this, NETWORK_TIMEOUT),
 m_header(NULL)
 {
 	assert(protoHandler != NULL);
 	assert(handler != NULL);
 	assert(port > 0U);
 
+	m_myPort = protoHandler->getPort();
+	addIndex();
+
 	m_pollInactivityTimer.start();
 
 	m_time = ::time(NULL);
@@ -72,6 +78,8 @@ m_header(NULL)
 
 CDExtraHandler::~CDExtraHandler()
 {
+	removeIndex();
+
 	if (m_direction == DIR_OUTGOING)
 		m_pool->release(m_handler);
 
@@ -157,39 +165,26 @@ std::string CDExtraHandler::getDongles()
 
 void CDExtraHandler::process(CHeaderData &header)
 {
-	in_addr   yourAddress = header.getYourAddress();
-	unsigned int yourPort = header.getYourPort();
-
-	for (auto it=m_DExtraHandlers.begin(); it!=m_DExtraHandlers.end(); it++) {
-		CDExtraHandler *dextraHandler = *it;
-		if (dextraHandler->m_yourAddress.s_addr==yourAddress.s_addr && dextraHandler->m_yourPort==yourPort)
-			dextraHandler->processInt(header);
-	}
+	auto range = m_index.equal_range(makeKey(header.getYourAddress(), header.getYourPort(), header.getMyPort()));
+	for (auto it=range.first; it!=range.second; it++)
+		it->second->processInt(header);
 }
 
 void CDExtraHandler::process(CAMBEData &data)
 {
-	in_addr   yourAddress = data.getYourAddress();
-	unsigned int yourPort = data.getYourPort();
-
-	for (auto it=m_DExtraHandlers.begin(); it!=m_DExtraHandlers.end(); it++) {
-		CDExtraHandler *dextraHandler = *it;
-		if (yourAddress.s_addr==dextraHandler->m_yourAddress.s_addr && yourPort==dextraHandler->m_yourPort)
-			dextraHandler->processInt(data);
-	}
+	auto range = m_index.equal_range(makeKey(data.getYourAddress(), data.getYourPort(), data.getMyPort()));
+	for (auto it=range.first; it!=range.second; it++)
+		it->second->processInt(data);
 }
 
 void CDExtraHandler::process(const CPollData &poll)
 {
 	std::string reflector = poll.getData1();
-	in_addr   yourAddress = poll.getYourAddress();
-	unsigned int yourPort = poll.getYourPort();
 	// reset all inactivity times from this reflector
-	for (auto it=m_DExtraHandlers.begin(); it!=m_DExtraHandlers.end(); it++) {
-		CDExtraHandler *handler = *it;
+	auto range = m_index.equal_range(makeKey(poll.getYourAddress(), poll.getYourPort(), poll.getMyPort()));
+	for (auto it=range.first; it!=range.second; it++) {
+		CDExtraHandler *handler = it->second;
 		if (		0==handler->m_reflector.compare(0, LONG_CALLSIGN_LENGTH-1, reflector, 0, LONG_CALLSIGN_LENGTH-1) &&
-					handler->m_yourAddress.s_addr == yourAddress.s_addr &&
-					handler->m_yourPort           == yourPort &&
 					handler->m_linkState          == DEXTRA_LINKED) {
 			handler->m_pollInactivityTimer.start();
 		}
@@ -346,7 +341,9 @@ void CDExtraHandler::gatewayUpdate(const std::string &dextraHandler, const std::
 			if (address.size()) {
 				// A new address, change the value
 				printf("Changing IP address of DExtra gateway or dextraHandler %s to %s\n", dextraHandler->m_reflector.c_str(), address.c_str());
+				dextraHandler->removeIndex();
 				dextraHandler->m_yourAddress.s_addr = ::inet_addr(address.c_str());
+				dextraHandler->addIndex();
 			} else {
 				printf("IP address for DExtra gateway or dextraHandler %s has been removed\n", dextraHandler->m_reflector.c_str());
 
@@ -364,16 +361,24 @@ void CDExtraHandler::gatewayUpdate(const std::string &dextraHandler, const std::
 	}
 }
 
-void CDExtraHandler::clock(unsigned int ms)
+uint64_t CDExtraHandler::makeKey(const in_addr &address, unsigned int yourPort, unsigned int myPort)
 {
-	for (auto it=m_DExtraHandlers.begin(); it!=m_DExtraHandlers.end(); ) {
-		CDExtraHandler *dextraHandler = *it;
-		bool ret = dextraHandler->clockInt(ms);
-		if (ret) {
-			delete dextraHandler;
-			it = m_DExtraHandlers.erase(it);
-		} else
-			it++;
+	return (uint64_t(address.s_addr) << 32) | (uint64_t(yourPort & 0xFFFFU) << 16) | uint64_t(myPort & 0xFFFFU);
+}
+
+void CDExtraHandler::addIndex()
+{
+	m_index.insert(std::make_pair(makeKey(m_yourAddress, m_yourPort, m_myPort), this));
+}
+
+void CDExtraHandler::removeIndex()
+{
+	auto range = m_index.equal_range(makeKey(m_yourAddress, m_yourPort, m_myPort));
+	for (auto it=range.first; it!=range.second; it++) {
+		if (it->second == this) {
+			m_index.erase(it);
+			return;
+		}
 	}
 }
 
@@ -560,14 +565,9 @@ bool CDExtraHandler::processInt(CConnectData &connect, CD_TYPE type)
 	}
 }
 
-bool CDExtraHandler::clockInt(unsigned int ms)
+void CDExtraHandler::timerExpired(CWheelTimer &timer)
 {
-	m_tryTimer.clock(ms);
-	m_pollTimer.clock(ms);
-	m_inactivityTimer.clock(ms);
-	m_pollInactivityTimer.clock(ms);
-
-	if (m_pollInactivityTimer.isRunning() && m_pollInactivityTimer.hasExpired()) {
+	if (&timer == &m_pollInactivityTimer) {
 		m_pollInactivityTimer.start();
 
 		delete m_header;
@@ -599,14 +599,14 @@ bool CDExtraHandler::clockInt(unsigned int ms)
 				m_linkState = DEXTRA_LINKING;
 				m_tryTimer.start(1U);
 				m_tryCount = 0U;
-				return false;
+				return;
 			}
 		}
 
-		return true;
-	}
-
-	if (m_pollTimer.isRunning() && m_pollTimer.hasExpired()) {
+		// this link is dead
+		m_DExtraHandlers.remove(this);
+		delete this;
+	} else if (&timer == &m_pollTimer) {
 		if (m_linkState == DEXTRA_LINKED) {
 			if (m_repeater.size()) {
 				std::string callsign = m_repeater;
@@ -620,20 +620,14 @@ bool CDExtraHandler::clockInt(unsigned int ms)
 		}
 
 		m_pollTimer.start();
-	}
-
-	if (m_inactivityTimer.isRunning() && m_inactivityTimer.hasExpired()) {
+	} else if (&timer == &m_inactivityTimer) {
 		delete m_header;
 		m_header = NULL;
 
 		m_dExtraId  = 0x00U;
 		m_dExtraSeq = 0x00U;
-
-		m_inactivityTimer.stop();
-	}
-
-	if (m_linkState == DEXTRA_LINKING) {
-		if (m_tryTimer.isRunning() && m_tryTimer.hasExpired()) {
+	} else if (&timer == &m_tryTimer) {
+		if (m_linkState == DEXTRA_LINKING) {
 			CConnectData reply(m_repeater, m_reflector, CT_LINK1, m_yourAddress, m_yourPort);
 			m_handler->writeConnect(reply);
 
@@ -641,8 +635,6 @@ bool CDExtraHandler::clockInt(unsigned int ms)
 			m_tryTimer.start(timeout);
 		}
 	}
-
-	return false;
 }
 
 void CDExtraHandler::writeHeaderInt(IReflectorCallback *handler, CHeaderData &header, DIRECTION direction)
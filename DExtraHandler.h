@@ -22,6 +22,8 @@
 #include <netinet/in.h>
 #include <string>
 #include <list>
+#include <unordered_map>
+#include <cstdint>
 
 #include "DExtraProtocolHandlerPool.h"
 #include "RemoteRepeaterData.h"
@@ -31,8 +33,8 @@
 #include "ConnectData.h"
 #include "HeaderData.h"
 #include "AMBEData.h"
+#include "TimerWheel.h"
 #include "PollData.h"
-#include "Timer.h"
 #include "Defs.h"
 
 enum DEXTRA_STATE {
@@ -41,7 +43,7 @@ enum DEXTRA_STATE {
 	DEXTRA_UNLINKING
 };
 
-class CDExtraHandler {
+class CDExtraHandler : public ITimerCallback {
 public:
 	static void setCallsign(const std::string &callsign);
 	static void setDExtraProtocolHandlerPool(CDExtraProtocolHandlerPool *pool);
@@ -60,7 +62,6 @@ public:
 	static void process(CConnectData &connect);
 
 	static void gatewayUpdate(const std::string &reflector, const std::string &address);
-	static void clock(unsigned int ms);
 
 	static bool stateChange();
 	static void writeStatus(FILE *file);
@@ -86,10 +87,12 @@ protected:
 	void writeHeaderInt(IReflectorCallback *handler, CHeaderData &header, DIRECTION direction);
 	void writeAMBEInt(IReflectorCallback *handler, CAMBEData &data, DIRECTION direction);
 
-	bool clockInt(unsigned int ms);
+	virtual void timerExpired(CWheelTimer &timer);
 
 private:
 	static std::list<CDExtraHandler *> m_DExtraHandlers;
+	// The same links, by remote address, remote port and local port
+	static std::unordered_multimap<uint64_t, CDExtraHandler *> m_index;
 
 	static std::string                 m_callsign;
 	static CDExtraProtocolHandlerPool *m_pool;
@@ -104,18 +107,23 @@ private:
 	CDExtraProtocolHandler *m_handler;
 	in_addr                 m_yourAddress;
 	unsigned int            m_yourPort;
+	unsigned int            m_myPort;
 	DIRECTION               m_direction;
 	DEXTRA_STATE            m_linkState;
 	IReflectorCallback     *m_destination;
 	time_t                  m_time;
-	CTimer                  m_pollTimer;
-	CTimer                  m_pollInactivityTimer;
-	CTimer                  m_tryTimer;
+	CWheelTimer             m_pollTimer;
+	CWheelTimer             m_pollInactivityTimer;
+	CWheelTimer             m_tryTimer;
 	unsigned int            m_tryCount;
 	unsigned int            m_dExtraId;
 	unsigned int            m_dExtraSeq;
-	CTimer                  m_inactivityTimer;
+	CWheelTimer             m_inactivityTimer;
 	CHeaderData            *m_header;
 
 	unsigned int calcBackoff();
+
+	static uint64_t makeKey(const in_addr &address, unsigned int yourPort, unsigned int myPort);
+	void addIndex();
+	void removeIndex();
 };
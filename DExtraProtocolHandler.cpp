@@ -23,8 +23,6 @@
 
 // #define	DUMP_TX
 
-const unsigned int BUFFER_LENGTH = 1000U;
-
 CDExtraProtocolHandler::CDExtraProtocolHandler(unsigned int port, const std::string& addr) :
 m_socket(addr, port),
 m_type(DE_NONE),
@@ -34,12 +32,10 @@ m_yourAddress(),
 m_yourPort(0U),
 m_myPort(port)
 {
-	m_buffer = new unsigned char[BUFFER_LENGTH];
 }
 
 CDExtraProtocolHandler::~CDExtraProtocolHandler()
 {
-	delete[] m_buffer;
 }
 
 bool CDExtraProtocolHandler::open()
@@ -52,6 +48,11 @@ unsigned int CDExtraProtocolHandler::getPort() const
 	return m_myPort;
 }
 
+int CDExtraProtocolHandler::getFD() const
+{
+	return m_socket.getFD();
+}
+
 bool CDExtraProtocolHandler::writeHeader(const CHeaderData& header)
 {
 	unsigned char buffer[60U];
@@ -128,7 +129,7 @@ bool CDExtraProtocolHandler::readPackets()
 	m_type = DE_NONE;
 
 	// No more data?
-	int length = m_socket.read(m_buffer, BUFFER_LENGTH, m_yourAddress, m_yourPort);
+	int length = m_socket.readNext(m_buffer, m_yourAddress, m_yourPort);
 	if (length <= 0)
 		return false;
 
@@ -157,37 +158,21 @@ bool CDExtraProtocolHandler::readPackets()
 	}
 }
 
-CHeaderData* CDExtraProtocolHandler::newHeader()
+bool CDExtraProtocolHandler::readHeader(CHeaderData& header)
 {
 	if (m_type != DE_HEADER)
-		return NULL;
-
-	CHeaderData* header = new CHeaderData;
+		return false;
 
 	// DExtra checksums are unreliable
-	bool res = header->setDExtraData(m_buffer, m_length, false, m_yourAddress, m_yourPort, m_myPort);
-	if (!res) {
-		delete header;
-		return NULL;
-	}
-
-	return header;
+	return header.setDExtraData(m_buffer, m_length, false, m_yourAddress, m_yourPort, m_myPort);
 }
 
-CAMBEData* CDExtraProtocolHandler::newAMBE()
+bool CDExtraProtocolHandler::readAMBE(CAMBEData& data)
 {
 	if (m_type != DE_AMBE)
-		return NULL;
-
-	CAMBEData* data = new CAMBEData;
-
-	bool res = data->setDExtraData(m_buffer, m_length, m_yourAddress, m_yourPort, m_myPort);
-	if (!res) {
-		delete data;
-		return NULL;
-	}
+		return false;
 
-	return data;
+	return data.setDExtraData(m_buffer, m_length, m_yourAddress, m_yourPort, m_myPort);
 }
 
 CPollData* CDExtraProtocolHandler::newPoll()
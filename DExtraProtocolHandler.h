@@ -45,6 +45,7 @@ public:
 	bool open();
 
 	unsigned int getPort() const;
+	int          getFD() const;
 
 	bool writeHeader(const CHeaderData& header);
 	bool writeAMBE(const CAMBEData& data);
@@ -52,8 +53,8 @@ public:
 	bool writePoll(const CPollData& poll);
 
 	DEXTRA_TYPE   read();
-	CHeaderData*  newHeader();
-	CAMBEData*    newAMBE();
+	bool          readHeader(CHeaderData& header);
+	bool          readAMBE(CAMBEData& data);
 	CPollData*    newPoll();
 	CConnectData* newConnect();
 
@@ -62,7 +63,7 @@ public:
 private:
 	CUDPReaderWriter m_socket;
 	DEXTRA_TYPE      m_type;
-	unsigned char*   m_buffer;
+	const unsigned char*   m_buffer;
 	unsigned int     m_length;
 	in_addr          m_yourAddress;
 	unsigned int     m_yourPort;
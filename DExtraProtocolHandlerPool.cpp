@@ -24,7 +24,8 @@
 
 CDExtraProtocolHandlerPool::CDExtraProtocolHandlerPool(const unsigned int port, const std::string &addr) :
 m_basePort(port),
-m_address(addr)
+m_address(addr),
+m_epoll(NULL)
 {
 	m_index = m_pool.end();
 	printf("DExtra UDP port base = %u\n", port);
@@ -48,6 +49,8 @@ CDExtraProtocolHandler* CDExtraProtocolHandlerPool::getHandler()
 	if (proto) {
 		if (proto->open()) {
 			m_pool[port] = proto;
+			if (m_epoll)
+				m_epoll->add(proto->getFD(), ES_DEXTRA, port);
 			printf("New CDExtraProtocolHandler now on UDP port %u.\n", port);
 		} else {
 			delete proto;
@@ -64,6 +67,10 @@ void CDExtraProtocolHandlerPool::release(CDExtraProtocolHandler *handler)
 	assert(handler != NULL);
 	for (auto it=m_pool.begin(); it!=m_pool.end(); it++) {
 		if (it->second == handler) {
+			if (m_index == it)
+				m_index = m_pool.end();
+			if (m_epoll)
+				m_epoll->remove(it->second->getFD());
 			it->second->close();
 			delete it->second;
 			printf("Releasing CDExtraProtocolHandler on port %u.\n", it->first);
@@ -75,27 +82,30 @@ void CDExtraProtocolHandlerPool::release(CDExtraProtocolHandler *handler)
 	printf("ERROR: could not find CDExtraProtocolHander (port=%u) to release!\n", handler->getPort());
 }
 
-DEXTRA_TYPE CDExtraProtocolHandlerPool::read()
+void CDExtraProtocolHandlerPool::setEpoll(CEpoll *epoll)
 {
+	assert(epoll != NULL);
+
+	m_epoll = epoll;
+}
+
+// read only the handler bound to this port, after epoll has reported it as readable
+DEXTRA_TYPE CDExtraProtocolHandlerPool::read(unsigned int port)
+{
+	m_index = m_pool.find(port);
 	if (m_index == m_pool.end())
-		m_index = m_pool.begin();
-	while (m_index != m_pool.end()) {
-		DEXTRA_TYPE type = m_index->second->read();
-		if (type != DE_NONE)
-			return type;
-		m_index++;
-	}
-	return DE_NONE;
+		return DE_NONE;
+	return m_index->second->read();
 }
 
-CHeaderData *CDExtraProtocolHandlerPool::newHeader()
+bool CDExtraProtocolHandlerPool::readHeader(CHeaderData &header)
 {
-	return m_index->second->newHeader();
+	return m_index->second->readHeader(header);
 }
 
-CAMBEData *CDExtraProtocolHandlerPool::newAMBE()
+bool CDExtraProtocolHandlerPool::readAMBE(CAMBEData &data)
 {
-	return m_index->second->newAMBE();
+	return m_index->second->readAMBE(data);
 }
 
 CPollData *CDExtraProtocolHandlerPool::newPoll()
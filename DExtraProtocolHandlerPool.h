@@ -23,6 +23,7 @@
 #include <map>
 
 #include "DExtraProtocolHandler.h"
+#include "Epoll.h"
 
 class CDExtraProtocolHandlerPool {
 public:
@@ -32,9 +33,11 @@ public:
 	CDExtraProtocolHandler *getHandler();
 	void release(CDExtraProtocolHandler *handler);
 
-	DEXTRA_TYPE   read();
-	CHeaderData  *newHeader();
-	CAMBEData    *newAMBE();
+	void setEpoll(CEpoll *epoll);
+
+	DEXTRA_TYPE   read(unsigned int port);
+	bool          readHeader(CHeaderData &header);
+	bool          readAMBE(CAMBEData &data);
 	CPollData    *newPoll();
 	CConnectData *newConnect();
 
@@ -45,5 +48,6 @@ private:
 	std::map<unsigned int, CDExtraProtocolHandler *>::iterator m_index;
 	unsigned int m_basePort;
 	std::string m_address;
+	CEpoll     *m_epoll;
 };
 
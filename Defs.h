@@ -122,4 +122,5 @@ enum GATEWAY_TYPE {
 	GT_SMARTGROUP
 };
 
-const unsigned int TIME_PER_TIC_MS = 5U;
+// the longest the main loop sleeps in epoll_wait before clocking the timers
+const unsigned int MAX_WAIT_MS = 100U;
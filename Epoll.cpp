@@ -0,0 +1,103 @@
+/*
+ *   Copyright (c) 2018 by Thomas A. Early N7TAE
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation; either version 2 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <unistd.h>
+
+#include "Epoll.h"
+
+CEpoll::CEpoll() :
+m_fd(-1)
+{
+	::memset(m_events, 0, sizeof(m_events));
+}
+
+CEpoll::~CEpoll()
+{
+	close();
+}
+
+bool CEpoll::open()
+{
+	m_fd = ::epoll_create1(EPOLL_CLOEXEC);
+	if (m_fd < 0) {
+		printf("Cannot create the epoll instance, err: %s\n", strerror(errno));
+		return false;
+	}
+
+	return true;
+}
+
+bool CEpoll::add(int fd, EPOLL_SOURCE source, unsigned int port)
+{
+	if (m_fd < 0 || fd < 0)
+		return false;
+
+	struct epoll_event ev;
+	::memset(&ev, 0, sizeof(struct epoll_event));
+	ev.events = EPOLLIN;
+	ev.data.u64 = ((uint64_t)source << 32) | (uint64_t)port;
+
+	if (::epoll_ctl(m_fd, EPOLL_CTL_ADD, fd, &ev) == -1) {
+		printf("Cannot add socket to epoll (port: %u), err: %s\n", port, strerror(errno));
+		return false;
+	}
+
+	return true;
+}
+
+void CEpoll::remove(int fd)
+{
+	if (m_fd < 0 || fd < 0)
+		return;
+
+	// a closed socket is removed by the kernel, so an error here is harmless
+	::epoll_ctl(m_fd, EPOLL_CTL_DEL, fd, NULL);
+}
+
+int CEpoll::wait(unsigned int timeout)
+{
+	int ret = ::epoll_wait(m_fd, m_events, EPOLL_MAX_EVENTS, int(timeout));
+	if (ret < 0) {
+		if (errno != EINTR)
+			printf("Error returned from epoll_wait, err: %s\n", strerror(errno));
+		return 0;
+	}
+
+	return ret;
+}
+
+EPOLL_SOURCE CEpoll::getSource(int index) const
+{
+	return EPOLL_SOURCE(m_events[index].data.u64 >> 32);
+}
+
+unsigned int CEpoll::getPort(int index) const
+{
+	return (unsigned int)(m_events[index].data.u64 & 0xFFFFFFFFULL);
+}
+
+void CEpoll::close()
+{
+	if (m_fd >= 0) {
+		::close(m_fd);
+		m_fd = -1;
+	}
+}
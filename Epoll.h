@@ -0,0 +1,59 @@
+/*
+ *   Copyright (c) 2018 by Thomas A. Early N7TAE
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation; either version 2 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <sys/epoll.h>
+
+// Where a ready socket came from, used by CSGSThread to dispatch it
+enum EPOLL_SOURCE {
+	ES_G2,
+	ES_DEXTRA,
+	ES_DCS,
+	ES_REMOTE,
+	ES_IRCDDB
+};
+
+const unsigned int EPOLL_MAX_EVENTS = 64U;
+
+// A thin wrapper around a level-triggered epoll instance. Each registered socket
+// carries its source and local UDP port, so the ready list can be dispatched
+// straight to the protocol handler that owns it.
+class CEpoll {
+public:
+	CEpoll();
+	~CEpoll();
+
+	bool open();
+
+	bool add(int fd, EPOLL_SOURCE source, unsigned int port);
+	void remove(int fd);
+
+	// Wait up to timeout ms for readiness, returns the number of ready sockets
+	int wait(unsigned int timeout);
+
+	EPOLL_SOURCE getSource(int index) const;
+	unsigned int getPort(int index) const;
+
+	void close();
+
+private:
+	int                m_fd;
+	struct epoll_event m_events[EPOLL_MAX_EVENTS];
+};
@@ -32,7 +32,7 @@ CG2ProtocolHandler* CG2Handler::m_handler = NULL;
 CG2Handler::CG2Handler(const in_addr& address, unsigned int id) :
 m_address(address),
 m_id(id),
-m_inactivityTimer(1000U, NETWORK_TIMEOUT)
+m_inactivityTimer(this, NETWORK_TIMEOUT)
 {
 	m_inactivityTimer.start();
 }
@@ -88,20 +88,6 @@ void CG2Handler::process(CAMBEData& data)
 	}
 }
 
-void CG2Handler::clock(unsigned int ms)
-{
-	for (unsigned int i = 0U; i < m_maxRoutes; i++) {
-		CG2Handler* route = m_routes[i];
-		if (route != NULL) {
-			bool ret = route->clockInt(ms);
-			if (ret) {
-				delete route;
-				m_routes[i] = NULL;
-			}
-		}
-	}
-}
-
 void CG2Handler::finalise()
 {
 	for (unsigned int i = 0U; i < m_maxRoutes; i++)
@@ -110,14 +96,15 @@ void CG2Handler::finalise()
 	delete[] m_routes;
 }
 
-bool CG2Handler::clockInt(unsigned int ms)
+void CG2Handler::timerExpired(CWheelTimer &)
 {
-	m_inactivityTimer.clock(ms);
+	printf("Inactivity timeout for a G2 route has expired\n");
 
-	if (m_inactivityTimer.isRunning() && m_inactivityTimer.hasExpired()) {
-		printf("Inactivity timeout for a G2 route has expired\n");
-		return true;
+	for (unsigned int i = 0U; i < m_maxRoutes; i++) {
+		if (m_routes[i] == this) {
+			m_routes[i] = NULL;
+			delete this;
+			return;
+		}
 	}
-
-	return false;
 }
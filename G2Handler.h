@@ -24,10 +24,10 @@
 #include "G2ProtocolHandler.h"
 #include "DStarDefines.h"
 #include "HeaderData.h"
+#include "TimerWheel.h"
 #include "AMBEData.h"
-#include "Timer.h"
 
-class CG2Handler {
+class CG2Handler : public ITimerCallback {
 public:
 	static void initialise(unsigned int maxRoutes);
 
@@ -36,15 +36,13 @@ public:
 	static void process(CHeaderData& header);
 	static void process(CAMBEData& header);
 
-	static void clock(unsigned int ms);
-
 	static void finalise();
 
 protected:
 	CG2Handler(const in_addr& address, unsigned int id);
 	~CG2Handler();
 
-	bool clockInt(unsigned int ms);
+	virtual void timerExpired(CWheelTimer &timer);
 
 private:
 	static unsigned int        m_maxRoutes;
@@ -54,5 +52,5 @@ private:
 
 	in_addr           m_address;
 	unsigned int      m_id;
-	CTimer            m_inactivityTimer;
+	CWheelTimer       m_inactivityTimer;
 };
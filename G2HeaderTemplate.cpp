@@ -0,0 +1,78 @@
+/*
+ *   Copyright (c) 2018 by Thomas A. Early N7TAE
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation; either version 2 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+
+
+#include <cassert>
+#include <cstring>
+
+#include "G2HeaderTemplate.h"
+#include "DStarDefines.h"
+
+CG2HeaderTemplate::CG2HeaderTemplate() :
+m_csum()
+{
+	build("CQCQCQ", "", "");
+}
+
+CG2HeaderTemplate::~CG2HeaderTemplate()
+{
+}
+
+void CG2HeaderTemplate::build(const std::string &destination, const std::string &gateway, const std::string &repeater)
+{
+	// The same layout as CHeaderData::getG2Data()
+	CHeaderData header("", "", destination, gateway, repeater);
+	header.getG2Data(m_data, 56U, false);
+
+	m_csum.reset();
+	m_csum.update(m_data + 15U, 3U * LONG_CALLSIGN_LENGTH + 3U);
+}
+
+unsigned int CG2HeaderTemplate::getG2Data(const CHeaderData &header, unsigned char *data, unsigned int length) const
+{
+	assert(data != NULL);
+	assert(length >= 56U);
+
+	::memcpy(data, m_data, 56U);
+
+	data[9]  = header.getBand1();
+	data[10] = header.getBand2();
+	data[11] = header.getBand3();
+
+	unsigned int id = header.getId();
+	data[12] = id / 256U;
+	data[13] = id % 256U;
+
+	::memcpy(data + 42U, header.getMyCall1().c_str(), LONG_CALLSIGN_LENGTH);
+	::memcpy(data + 50U, header.getMyCall2().c_str(), SHORT_CALLSIGN_LENGTH);
+
+	CCCITTChecksum csum(m_csum);
+	if (data[15] == header.getFlag1() && data[16] == header.getFlag2() && data[17] == header.getFlag3()) {
+		csum.update(data + 42U, LONG_CALLSIGN_LENGTH + SHORT_CALLSIGN_LENGTH);
+	} else {
+		// The template was built with no flags set, so start the checksum again
+		data[15] = header.getFlag1();
+		data[16] = header.getFlag2();
+		data[17] = header.getFlag3();
+		csum.reset();
+		csum.update(data + 15U, 4U * LONG_CALLSIGN_LENGTH + SHORT_CALLSIGN_LENGTH + 3U);
+	}
+	csum.result(data + 54U);
+
+	return 56U;
+}
@@ -0,0 +1,42 @@
+/*
+ *   Copyright (c) 2018 by Thomas A. Early N7TAE
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation; either version 2 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+
+
+#pragma once
+
+#include <string>
+
+#include "CCITTChecksum.h"
+#include "HeaderData.h"
+
+// A G2 header for one repeater, serialized once. Only the id, band and MY
+// fields change from stream to stream, so those are patched into a copy and
+// the checksum is finished from the state saved just before the MY fields.
+class CG2HeaderTemplate {
+public:
+	CG2HeaderTemplate();
+	~CG2HeaderTemplate();
+
+	void build(const std::string &destination, const std::string &gateway, const std::string &repeater);
+
+	unsigned int getG2Data(const CHeaderData &header, unsigned char *data, unsigned int length) const;
+
+private:
+	unsigned char  m_data[56U];
+	CCCITTChecksum m_csum;		// over the flags, RPT2, RPT1 and YOUR
+};
@@ -18,12 +18,14 @@
  */
 
 #include <string>
+#include <cstring>
 #include "G2ProtocolHandler.h"
 #include "Utils.h"
 
 // #define	DUMP_TX
 
-const unsigned int BUFFER_LENGTH = 255U;
+// A header is sent five times in a row, anything later is a new stream that reused the id
+const std::chrono::milliseconds G2_REPEAT_WINDOW(1000);
 
 CG2ProtocolHandler::CG2ProtocolHandler(unsigned int port, const std::string& addr) :
 m_socket(addr, port),
@@ -31,15 +33,19 @@ m_type(GT_NONE),
 m_buffer(NULL),
 m_length(0U),
 m_address(),
-m_port(0U)
+m_port(0U),
+m_recent(),
+m_recentNext(0U),
+m_repeats(0UL)
 {
-	m_buffer = new unsigned char[BUFFER_LENGTH];
 }
 
 CG2ProtocolHandler::~CG2ProtocolHandler()
 {
-	delete[] m_buffer;
 	portmap.clear();
+
+	if (m_repeats)
+		printf("G2: %lu repeated headers were dropped\n", m_repeats);
 }
 
 bool CG2ProtocolHandler::open()
@@ -47,21 +53,34 @@ bool CG2ProtocolHandler::open()
 	return m_socket.open();
 }
 
+int CG2ProtocolHandler::getFD() const
+{
+	return m_socket.getFD();
+}
+
 bool CG2ProtocolHandler::writeHeader(const CHeaderData& header)
+{
+	in_addr addr = header.getYourAddress();
+
+	return writeHeader(header, addr, getPort(addr, header.getYourPort()));
+}
+
+bool CG2ProtocolHandler::writeHeader(const CHeaderData& header, const in_addr& address, unsigned int port)
 {
 	unsigned char buffer[60U];
 	unsigned int length = header.getG2Data(buffer, 60U, true);
 
+	return writeHeader(buffer, length, address, port);
+}
+
+bool CG2ProtocolHandler::writeHeader(const unsigned char* buffer, unsigned int length, const in_addr& address, unsigned int port)
+{
 #if defined(DUMP_TX)
 	CUtils::dump("Sending Header", buffer, length);
 #endif
 
-	in_addr addr = header.getYourAddress();
-	auto found = portmap.find(addr.s_addr);
-	unsigned int port = (portmap.end()==found) ? header.getYourPort() : found->second;
-
 	for (unsigned int i = 0U; i < 5U; i++) {
-		bool res = m_socket.write(buffer, length, addr, port);
+		bool res = m_socket.write(buffer, length, address, port);
 		if (!res)
 			return false;
 	}
@@ -79,10 +98,50 @@ bool CG2ProtocolHandler::writeAMBE(const CAMBEData& data)
 #endif
 
 	in_addr addr = data.getYourAddress();
-	auto found = portmap.find(addr.s_addr);
-	unsigned int port = (portmap.end()==found) ? data.getYourPort() : found->second;
 
-	return m_socket.write(buffer, length, addr, port);
+	return m_socket.write(buffer, length, addr, getPort(addr, data.getYourPort()));
+}
+
+// The frame is encoded once, whatever the number of destinations
+bool CG2ProtocolHandler::writeAMBE(const CAMBEData& data, const std::vector<sockaddr_in>& destinations)
+{
+	unsigned char buffer[40U];
+	unsigned int length = data.getG2Data(buffer, 40U);
+
+#if defined(DUMP_TX)
+	CUtils::dump("Sending Data", buffer, length);
+#endif
+
+	return m_socket.write(buffer, length, destinations);
+}
+
+bool CG2ProtocolHandler::write(const unsigned char* buffer, unsigned int length, const in_addr& address, unsigned int port)
+{
+	return m_socket.write(buffer, length, address, port);
+}
+
+bool CG2ProtocolHandler::write(const unsigned char* buffer, unsigned int length, const std::vector<sockaddr_in>& destinations)
+{
+	return m_socket.write(buffer, length, destinations);
+}
+
+unsigned int CG2ProtocolHandler::getPort(const in_addr& address, unsigned int port) const
+{
+	auto found = portmap.find(address.s_addr);
+
+	return (portmap.end()==found) ? port : found->second;
+}
+
+sockaddr_in CG2ProtocolHandler::getDestination(const in_addr& address, unsigned int port) const
+{
+	sockaddr_in addr;
+	::memset(&addr, 0x00, sizeof(sockaddr_in));
+
+	addr.sin_family = AF_INET;
+	addr.sin_addr   = address;
+	addr.sin_port   = htons(getPort(address, port));
+
+	return addr;
 }
 
 G2_TYPE CG2ProtocolHandler::read()
@@ -101,7 +160,7 @@ bool CG2ProtocolHandler::readPackets()
 	m_type = GT_NONE;
 
 	// No more data?
-	int length = m_socket.read(m_buffer, BUFFER_LENGTH, m_address, m_port);
+	int length = m_socket.readNext(m_buffer, m_address, m_port);
 	if (length <= 0)
 		return false;
 
@@ -122,46 +181,57 @@ bool CG2ProtocolHandler::readPackets()
 		return true;
 	} else {
 		// Header or data packet type?
-		if ((m_buffer[14] & 0x80) == 0x80)
+		if ((m_buffer[14] & 0x80) == 0x80) {
+			// Only the first copy of a header goes any further
+			if (isRepeatHeader())
+				return true;
+
 			m_type = GT_HEADER;
-		else
+		} else
 			m_type = GT_AMBE;
 
 		return false;
 	}
 }
 
-CHeaderData* CG2ProtocolHandler::readHeader()
+// Remembers the header when it's the first of its stream
+bool CG2ProtocolHandler::isRepeatHeader()
 {
-	if (m_type != GT_HEADER)
-		return NULL;
-
-	CHeaderData* header = new CHeaderData;
-
-	// G2 checksums are unreliable
-	bool res = header->setG2Data(m_buffer, m_length, false, m_address, m_port);
-	if (!res) {
-		delete header;
-		return NULL;
+	unsigned int id = m_buffer[12] * 256U + m_buffer[13];
+	std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+
+	for (unsigned int i = 0U; i < G2_RECENT_HEADERS; i++) {
+		SRecentHeader &recent = m_recent[i];
+		if (recent.m_id == id && recent.m_address == m_address.s_addr && now - recent.m_time < G2_REPEAT_WINDOW) {
+			m_repeats++;
+			return true;
+		}
 	}
 
-	return header;
+	SRecentHeader &recent = m_recent[m_recentNext];
+	recent.m_address = m_address.s_addr;
+	recent.m_id      = id;
+	recent.m_time    = now;
+	m_recentNext = (m_recentNext + 1U) % G2_RECENT_HEADERS;
+
+	return false;
 }
 
-CAMBEData* CG2ProtocolHandler::readAMBE()
+bool CG2ProtocolHandler::readHeader(CHeaderData& header)
 {
-	if (m_type != GT_AMBE)
-		return NULL;
+	if (m_type != GT_HEADER)
+		return false;
 
-	CAMBEData* data = new CAMBEData;
+	// G2 checksums are unreliable
+	return header.setG2Data(m_buffer, m_length, false, m_address, m_port);
+}
 
-	bool res = data->setG2Data(m_buffer, m_length, m_address, m_port);
-	if (!res) {
-		delete data;
-		return NULL;
-	}
+bool CG2ProtocolHandler::readAMBE(CAMBEData& data)
+{
+	if (m_type != GT_AMBE)
+		return false;
 
-	return data;
+	return data.setG2Data(m_buffer, m_length, m_address, m_port);
 }
 
 void CG2ProtocolHandler::close()
@@ -19,13 +19,18 @@
 
 #pragma once
 
+#include <chrono>
 #include <unordered_map>
+#include <vector>
 
 #include "UDPReaderWriter.h"
 #include "DStarDefines.h"
 #include "HeaderData.h"
 #include "AMBEData.h"
 
+// The streams whose headers have just been seen, the copies that follow are dropped
+const unsigned int G2_RECENT_HEADERS = 16U;
+
 enum G2_TYPE {
 	GT_NONE,
 	GT_HEADER,
@@ -39,12 +44,26 @@ public:
 
 	bool open();
 
+	int getFD() const;
+
 	bool writeHeader(const CHeaderData& header);
 	bool writeAMBE(const CAMBEData& data);
 
+	// These don't touch the portmap, so they may be used from any thread
+	bool writeHeader(const CHeaderData& header, const in_addr& address, unsigned int port);
+	bool writeHeader(const unsigned char* buffer, unsigned int length, const in_addr& address, unsigned int port);
+	bool write(const unsigned char* buffer, unsigned int length, const in_addr& address, unsigned int port);
+	bool write(const unsigned char* buffer, unsigned int length, const std::vector<sockaddr_in>& destinations);
+	bool writeAMBE(const CAMBEData& data, const std::vector<sockaddr_in>& destinations);
+
+	// The port a G2 address was last heard from, or port if it hasn't been heard
+	unsigned int getPort(const in_addr& address, unsigned int port) const;
+	sockaddr_in  getDestination(const in_addr& address, unsigned int port) const;
+
 	G2_TYPE read();
-	CHeaderData* readHeader();
-	CAMBEData*   readAMBE();
+	// Fill in the caller's object, so nothing is allocated per datagram
+	bool readHeader(CHeaderData& header);
+	bool readAMBE(CAMBEData& data);
 
 	void close();
 
@@ -53,10 +72,20 @@ private:
 
 	CUDPReaderWriter m_socket;
 	G2_TYPE          m_type;
-	unsigned char*   m_buffer;
+	const unsigned char*   m_buffer;
 	unsigned int     m_length;
 	in_addr          m_address;
 	unsigned int     m_port;
 
+	struct SRecentHeader {
+		uint32_t m_address;
+		unsigned int m_id;
+		std::chrono::steady_clock::time_point m_time;
+	};
+	SRecentHeader    m_recent[G2_RECENT_HEADERS];
+	unsigned int     m_recentNext;
+	unsigned long    m_repeats;
+
 	bool readPackets();
+	bool isRepeatHeader();
 };
@@ -19,37 +19,89 @@
 
 #include "GatewayCache.h"
 
-CGatewayCache::CGatewayCache()
+// Reflectors from the host files are in here too, so gateways never time out
+CGatewayCache::CGatewayCache() :
+m_cache(0U, 0U)
 {
 }
 
 CGatewayCache::~CGatewayCache()
 {
-	for (std::unordered_map<std::string, CGatewayRecord *>::iterator it = m_cache.begin(); it != m_cache.end(); ++it)
-		delete it->second;
 }
 
-CGatewayRecord* CGatewayCache::find(const std::string& gateway)
+const CGatewayRecord* CGatewayCache::find(const CCallsign& gateway) const
 {
-	return m_cache[gateway];
+	return m_cache.find(gateway);
 }
 
-void CGatewayCache::update(const std::string& gateway, const std::string& address, DSTAR_PROTOCOL protocol, bool addrLock, bool protoLock)
+void CGatewayCache::update(const CCallsign& gateway, const std::string& address, DSTAR_PROTOCOL protocol, bool addrLock, bool protoLock)
 {
-	CGatewayRecord* rec = m_cache[gateway];
+	CGatewayRecord* rec = m_cache.peek(gateway);
 
 	in_addr addr_in;
 	addr_in.s_addr = ::inet_addr(address.c_str());
 
 	if (rec == NULL)
 		// A brand new record is needed
-		m_cache[gateway] = new CGatewayRecord(gateway, addr_in, protocol, addrLock, protoLock);
-	else
+		m_cache.insert(gateway, CGatewayRecord(gateway, addr_in, protocol, addrLock, protoLock));
+	else {
 		// Update an existing record
 		rec->setData(addr_in, protocol, addrLock, protoLock);
+		m_cache.touch(gateway);
+	}
+}
+
+void CGatewayCache::setLimits(unsigned int capacity)
+{
+	m_cache.setLimits(capacity, 0U);
+}
+
+struct SGatewaySnapshot {
+	uint64_t m_gateway;
+	uint32_t m_address;		// network byte order
+	uint32_t m_protocol;
+};
+
+// Only what was learnt from ircDDB, the host files are read again at start up
+void CGatewayCache::save(CSnapshotWriter &snapshot, unsigned int section) const
+{
+	m_cache.forEach([&](const CCallsign &key, time_t, const CGatewayRecord &rec) {
+		if (rec.isLocked())
+			return;
+
+		SGatewaySnapshot s = { key.getValue(), rec.getAddress().s_addr, uint32_t(rec.getProtocol()) };
+		snapshot.add(section, &s, sizeof(SGatewaySnapshot));
+	});
+}
+
+unsigned int CGatewayCache::load(const CSnapshotReader &snapshot, unsigned int section)
+{
+	unsigned int count;
+	const SGatewaySnapshot *s = snapshot.getSection<SGatewaySnapshot>(section, count);
+
+	for (unsigned int i = 0U; i < count; i++) {
+		CCallsign gateway(CCallsign::fromValue(s[i].m_gateway));
+		in_addr address;
+		address.s_addr = s[i].m_address;
+		m_cache.insert(gateway, CGatewayRecord(gateway, address, DSTAR_PROTOCOL(s[i].m_protocol), false, false));
+	}
+
+	return count;
+}
+
+unsigned int CGatewayCache::expire()
+{
+	return m_cache.expire();
 }
 
 unsigned int CGatewayCache::getCount() const
 {
-	return m_cache.size();
+	return m_cache.getCount();
+}
+
+void CGatewayCache::getStats(unsigned long &hits, unsigned long &misses, unsigned long &evictions) const
+{
+	hits      = m_cache.getHits();
+	misses    = m_cache.getMisses();
+	evictions = m_cache.getEvictions();
 }
@@ -20,17 +20,19 @@
 #pragma once
 
 #include <string>
-#include <unordered_map>
 #include <sys/socket.h>
 #include <netinet/in.h>
 #include <arpa/inet.h>
 
 #include "DStarDefines.h"
+#include "SnapshotFile.h"
+#include "LRUCache.h"
+#include "Callsign.h"
 #include "Defs.h"
 
 class CGatewayRecord {
 public:
-	CGatewayRecord(const std::string& gateway, in_addr address, DSTAR_PROTOCOL protocol, bool addrLock, bool protoLock) :
+	CGatewayRecord(const CCallsign& gateway, in_addr address, DSTAR_PROTOCOL protocol, bool addrLock, bool protoLock) :
 	m_gateway(gateway),
 	m_address(address),
 	m_protocol(DP_UNKNOWN),
@@ -43,7 +45,7 @@ public:
 		}
 	}
 
-	std::string getGateway() const
+	CCallsign getGateway() const
 	{
 		return m_gateway;
 	}
@@ -58,6 +60,12 @@ public:
 		return m_protocol;
 	}
 
+	// The address came from a host file
+	bool isLocked() const
+	{
+		return m_addrLock;
+	}
+
 	void setData(in_addr address, DSTAR_PROTOCOL protocol, bool addrLock, bool protoLock)
 	{
 		if (!m_addrLock) {
@@ -74,7 +82,7 @@ public:
 	}
 
 private:
-	std::string       m_gateway;
+	CCallsign      m_gateway;
 	in_addr        m_address;
 	DSTAR_PROTOCOL m_protocol;
 	bool           m_addrLock;
@@ -86,12 +94,22 @@ public:
 	CGatewayCache();
 	~CGatewayCache();
 
-	CGatewayRecord* find(const std::string& gateway);
+	const CGatewayRecord* find(const CCallsign& gateway) const;
+
+	void update(const CCallsign& gateway, const std::string& address, DSTAR_PROTOCOL protocol, bool addrLock, bool protoLock);
+
+	void setLimits(unsigned int capacity);
+
+	// Snapshots for a warm restart
+	void save(CSnapshotWriter &snapshot, unsigned int section) const;
+	unsigned int load(const CSnapshotReader &snapshot, unsigned int section);
 
-	void update(const std::string& gateway, const std::string& address, DSTAR_PROTOCOL protocol, bool addrLock, bool protoLock);
+	// Drop the records that are too old to be found
+	unsigned int expire();
 
 	unsigned int getCount() const;
+	void getStats(unsigned long &hits, unsigned long &misses, unsigned long &evictions) const;
 
 private:
-	std::unordered_map<std::string, CGatewayRecord *> m_cache;
+	CLRUCache<CGatewayRecord> m_cache;
 };
@@ -24,6 +24,7 @@
 
 #include "SlowDataEncoder.h"
 #include "GroupHandler.h"
+#include "GroupWorker.h"
 #include "DExtraHandler.h"		// DEXTRA_LINK
 #include "DCSHandler.h"			// DCS_LINK
 #include "Utils.h"
@@ -34,51 +35,107 @@ const unsigned int MESSAGE_DELAY = 4U;
 CG2ProtocolHandler *CGroupHandler::m_g2Handler = NULL;
 CIRCDDB            *CGroupHandler::m_irc = NULL;
 CCacheManager      *CGroupHandler::m_cache = NULL;
+CUserLookup        *CGroupHandler::m_lookup = NULL;
 std::string         CGroupHandler::m_gateway;
+unsigned int        CGroupHandler::m_reportWindow = 0U;
+std::string         CGroupHandler::m_sgsInfo;
 std::list<CGroupHandler *> CGroupHandler::m_Groups;
+std::unordered_map<std::string, CGroupHandler *> CGroupHandler::m_callsignIndex;
+std::unordered_map<unsigned int, CGroupHandler *> CGroupHandler::m_idIndex;
 
 
-CSGSUser::CSGSUser(const std::string &callsign, unsigned int timeout) :
+CSGSUser::CSGSUser(const std::string &callsign, unsigned int timeout, bool permanent, CGroupHandler *group) :
 m_callsign(callsign),
-m_timer(1000U, timeout)
+m_permanent(permanent),
+m_group(group),
+m_timer(this, timeout),
+m_repeater(),
+m_reported(0),
+m_reportDue(false)
 {
-	m_timer.start();
+	assert(group != NULL);
+
+	reset();
 }
 
 CSGSUser::~CSGSUser()
 {
 }
 
-bool CSGSUser::clock(unsigned int ms)
+// permanent users never time out, so their timer is never started
+bool CSGSUser::hasExpired() const
 {
-	m_timer.clock(ms);
-
-	return m_timer.isRunning() && m_timer.hasExpired();
+	return !m_permanent && !m_timer.isRunning();
 }
 
-bool CSGSUser::hasExpired()
+void CSGSUser::reset()
 {
-	return m_timer.isRunning() && m_timer.hasExpired();
+	if (!m_permanent)
+		m_timer.start();
 }
 
-void CSGSUser::reset()
+std::string CSGSUser::getCallsign() const
 {
-	m_timer.start();
+	return m_callsign.getString();
 }
 
-std::string CSGSUser::getCallsign() const
+const CCallsign &CSGSUser::getKey() const
 {
 	return m_callsign;
 }
 
-CTimer CSGSUser::getTimer() const
+const CCallsign &CSGSUser::getRepeater() const
+{
+	return m_repeater;
+}
+
+void CSGSUser::setRepeater(const CCallsign &repeater)
+{
+	m_repeater = repeater;
+}
+
+// QuadNet hears about a user at most once a window, true if it should now
+bool CSGSUser::report(time_t now, unsigned int window)
+{
+	if (now - m_reported < time_t(window)) {
+		m_reportDue = true;
+		return false;
+	}
+
+	setReported(now);
+	return true;
+}
+
+bool CSGSUser::isReportDue() const
+{
+	return m_reportDue;
+}
+
+time_t CSGSUser::getReportTime(unsigned int window) const
+{
+	return m_reported + time_t(window);
+}
+
+void CSGSUser::setReported(time_t now)
+{
+	m_reported  = now;
+	m_reportDue = false;
+}
+
+const CWheelTimer &CSGSUser::getTimer() const
 {
 	return m_timer;
 }
 
-CSGSId::CSGSId(unsigned int id, unsigned int timeout, CSGSUser *user) :
+void CSGSUser::timerExpired(CWheelTimer &)
+{
+	m_group->userExpired(this);
+}
+
+CSGSId::CSGSId(unsigned int id, unsigned int timeout, CSGSUser *user, CGroupHandler *group) :
 m_id(id),
-m_timer(1000U, timeout),
+m_group(group),
+m_timer(this, timeout),
 m_login(false),
 m_info(false),
 m_logoff(false),
@@ -87,6 +144,7 @@ m_user(user),
 m_textCollector()
 {
 	assert(user != NULL);
+	assert(group != NULL);
 
 	m_timer.start();
 }
@@ -127,16 +185,9 @@ void CSGSId::setEnd()
 	m_end = true;
 }
 
-bool CSGSId::clock(unsigned int ms)
-{
-	m_timer.clock(ms);
-
-	return m_timer.isRunning() && m_timer.hasExpired();
-}
-
-bool CSGSId::hasExpired()
+void CSGSId::timerExpired(CWheelTimer &)
 {
-	return m_timer.isRunning() && m_timer.hasExpired();
+	m_group->idExpired(this);
 }
 
 bool CSGSId::isLogin() const
@@ -174,9 +225,14 @@ void CGroupHandler::add(const std::string &callsign, const std::string &logoff,
 {
 	CGroupHandler *group = new CGroupHandler(callsign, logoff, repeater, infoText, permanent, userTimeout, callsignSwitch, txMsgSwitch, reflector);
 
-	if (group)
+	if (group) {
 		m_Groups.push_back(group);
-	else
+		// both the subscribe and the unsubscribe callsign lead to the group, the
+		// first group wins like the old linear search, and a blank one leads nowhere
+		m_callsignIndex.emplace(group->m_groupCallsign, group);
+		if (group->m_offCallsign.size() && group->m_offCallsign.compare("        "))
+			m_callsignIndex.emplace(group->m_offCallsign, group);
+	} else
 		printf("Cannot allocate Smart Group with callsign %s\n", callsign.c_str());
 }
 
@@ -201,42 +257,61 @@ void CGroupHandler::setCache(CCacheManager *cache)
 	m_cache = cache;
 }
 
+void CGroupHandler::setLookup(CUserLookup *lookup)
+{
+	assert(lookup != NULL);
+
+	m_lookup = lookup;
+}
+
+void CGroupHandler::setReportWindow(unsigned int window)
+{
+	m_reportWindow = window;
+}
+
 void CGroupHandler::setGateway(const std::string &gateway)
 {
 	m_gateway = gateway;
 }
 
-CGroupHandler *CGroupHandler::findGroup(const std::string &callsign)
+// Each group is pinned to one worker, so its frames are always sent in order
+void CGroupHandler::setWorkers(const std::vector<CGroupWorker *> &workers)
 {
-	for (auto it=m_Groups.begin(); it!=m_Groups.end(); it++) {
-		if (0 == (*it)->m_groupCallsign.compare(callsign))
-			return *it;
+	if (workers.empty())
+		return;
+
+	unsigned int i = 0U;
+	for (auto it=m_Groups.begin(); it!=m_Groups.end(); it++, i++) {
+		(*it)->m_worker = workers[i % workers.size()];
+		printf("Smart Group %s is sent by worker %u\n", (*it)->m_groupCallsign.c_str(), (*it)->m_worker->getIndex());
 	}
-	return NULL;
+}
+
+CGroupHandler *CGroupHandler::findGroup(const std::string &callsign)
+{
+	auto it = m_callsignIndex.find(callsign);
+	if (m_callsignIndex.end() == it || it->second->m_groupCallsign.compare(callsign))
+		return NULL;
+
+	return it->second;
 }
 
 CGroupHandler *CGroupHandler::findGroup(const CHeaderData &header)
 {
-	std::string your = header.getYourCall();
+	auto it = m_callsignIndex.find(header.getYourCall());
+	if (m_callsignIndex.end() == it)
+		return NULL;
 
-	for (auto it=m_Groups.begin(); it!=m_Groups.end(); it++) {
-		if (0 == (*it)->m_groupCallsign.compare(your))
-			return *it;
-		if (0 == (*it)->m_offCallsign.compare(your))
-			return *it;
-	}
-	return NULL;
+	return it->second;
 }
 
 CGroupHandler *CGroupHandler::findGroup(const CAMBEData &data)
 {
-	unsigned int id = data.getId();
+	auto it = m_idIndex.find(data.getId());
+	if (m_idIndex.end() == it)
+		return NULL;
 
-	for (auto it=m_Groups.begin(); it!=m_Groups.end(); it++) {
-		if ((*it)->m_id == id)
-			return *it;
-	}
-	return NULL;
+	return it->second;
 }
 
 std::list<std::string> CGroupHandler::listGroups()
@@ -263,22 +338,38 @@ CRemoteGroup *CGroupHandler::getInfo() const
 
 void CGroupHandler::finalise()
 {
+	m_callsignIndex.clear();
+	m_idIndex.clear();
+
 	while (m_Groups.size()) {
 		delete m_Groups.front();
 		m_Groups.pop_front();
 	}
 }
 
-void CGroupHandler::clock(unsigned int ms)
+void CGroupHandler::link()
 {
 	for (auto it=m_Groups.begin(); it!=m_Groups.end(); it++)
-		(*it)->clockInt(ms);
+		(*it)->linkInt();
 }
 
-void CGroupHandler::link()
+bool CGroupHandler::relink()
 {
-	for (auto it=m_Groups.begin(); it!=m_Groups.end(); it++)
-		(*it)->linkInt();
+	bool pending = false;
+	for (auto it=m_Groups.begin(); it!=m_Groups.end(); it++) {
+		CGroupHandler *group = *it;
+		if (!group->m_linkPending)
+			continue;
+
+		// Only try again once the address is known, so as not to repeat the warning
+		CRepeaterData data;
+		if (m_cache->findRepeater(group->m_linkReflector, data))
+			group->linkInt();
+
+		pending = pending || group->m_linkPending;
+	}
+
+	return pending;
 }
 
 CGroupHandler::CGroupHandler(const std::string &callsign, const std::string &logoff, const std::string &repeater, const std::string &infoText, const std::string &permanent,
@@ -293,17 +384,27 @@ m_linkReflector(reflector),
 m_linkGateway(),
 m_linkStatus(LS_NONE),
 m_oldlinkStatus(LS_INIT),
-m_linkTimer(1000U, NETWORK_TIMEOUT),
+m_linkTimer(this, NETWORK_TIMEOUT),
+m_infoTimer(this, 1U),			// 1 second
+m_linkPending(false),
 m_id(0x00U),
-m_announceTimer(1000U, 2U * 60U),		// 2 minutes
+m_announceTimer(this, 2U * 60U),		// 2 minutes
+m_expiryTimer(this, 1U),		// 1 second
+m_reportTimer(this, 1U),		// started with the report window
 m_userTimeout(userTimeout),
 m_callsignSwitch(callsignSwitch),
 m_txMsgSwitch(txMsgSwitch),
 m_ids(),
 m_users(),
-m_repeaters()
+m_repeaters(),
+m_gateways(),
+m_expiredUsers(),
+m_worker(NULL),
+m_fanout(),
+m_exclude()
 {
 	m_announceTimer.start();
+	m_infoTimer.start();
 
 	// set link type
 	if (m_linkReflector.size())
@@ -330,7 +431,7 @@ m_repeaters()
 				if (newcall.size() > 3) {
 					CUtils::ToUpper(newcall);
 					newcall.resize(LONG_CALLSIGN_LENGTH, ' ');
-					m_permanent.insert(newcall);
+					m_permanent.insert(CCallsign(newcall));
 					token = strtok(NULL, ",");
 				}
 			}
@@ -352,6 +453,7 @@ CGroupHandler::~CGroupHandler()
 	for (auto it = m_repeaters.begin(); it != m_repeaters.end(); ++it)
 		delete it->second;
 	m_repeaters.empty();
+	m_gateways.clear();
 	m_permanent.erase(m_permanent.begin(), m_permanent.end());
 }
 
@@ -360,76 +462,73 @@ void CGroupHandler::process(CHeaderData &header)
 	std::string my   = header.getMyCall1();
 	std::string your = header.getYourCall();
 	unsigned int id = header.getId();
+	CCallsign key(my);
 
-	CSGSUser *group_user = m_users[my];	// if not found, m_user[my] will be created and its value will be set to NULL
+	CSGSUser *group_user = m_users[key];	// if not found, m_user[key] will be created and its value will be set to NULL
 	bool islogin = false;
 
 	// Ensure that this user is in the cache.
-	CUserData *userData = m_cache->findUser(my);	// userData is a new record (or NULL), so we have to delete or save it
-													// to prevent a memory leak
-	if (NULL == userData)
-		m_irc->findUser(my);
+	CUserData userData;
+	bool isCached = m_lookup->find(my, userData);
 
 	if (0 == your.compare(m_groupCallsign)) {
 		// This is a normal message for logging in/relaying
 		if (group_user == NULL) {
 			printf("Adding %s to Smart Group %s\n", my.c_str(), your.c_str());
 			// This is a new user, add him to the list
-			group_user = new CSGSUser(my, m_userTimeout * 60U);
-			m_users[my] = group_user;
+			group_user = new CSGSUser(my, m_userTimeout * 60U, m_permanent.end() != m_permanent.find(key), this);
+			m_users[key] = group_user;
+			if (isCached)
+				setUserRepeater(group_user, userData);
 
 			logUser(LU_ON, your, my);	// inform Quadnet
+			group_user->setReported(::time(NULL));
 
 			// add a new Id for this message
-			CSGSId* tx = new CSGSId(id, MESSAGE_DELAY, group_user);
+			CSGSId* tx = new CSGSId(id, MESSAGE_DELAY, group_user, this);
 			tx->setLogin();
 			m_ids[id] = tx;
 			islogin = true;
 		} else {
 			group_user->reset();
+			// they may have moved since we last heard them
+			if (isCached)
+				setUserRepeater(group_user, userData);
 
 			// Check that it isn't a duplicate header
 			CSGSId* tx = m_ids[id];
 			if (tx) {
-				//printf("Duplicate header from %s, deleting userData...\n", my.c_str());
-				delete userData;
+				//printf("Duplicate header from %s\n", my.c_str());
 				return;
 			}
 			//printf("Updating %s on Smart Group %s\n", my.c_str(), your.c_str());
-			logUser(LU_ON, your, my);	// this will be an update
-			m_ids[id] = new CSGSId(id, MESSAGE_DELAY, group_user);
+			reportUser(group_user);	// this will be an update
+			m_ids[id] = new CSGSId(id, MESSAGE_DELAY, group_user, this);
 		}
 	} else {
-		// unsubscribe was sent by someone
-		if (userData) {
-			delete userData;
-			userData = NULL;
-		}
-
-		// This is a logoff message
+		// unsubscribe was sent by someone, this is a logoff message
 		if (NULL == group_user) {	// Not a known user, ignore
-			m_users.erase(my);	// we created it, now we don't need it
+			m_users.erase(key);	// we created it, now we don't need it
 			return;
 		}
 
 		printf("Removing %s from Smart Group %s\n", group_user->getCallsign().c_str(), m_groupCallsign.c_str());
 		logUser(LU_OFF, m_groupCallsign, my);	// inform Quadnet
 		// Remove the user from the user list
-		m_users.erase(my);
+		releaseRepeater(group_user);
+		m_users.erase(key);
 
-		CSGSId* tx = new CSGSId(id, MESSAGE_DELAY, group_user);
+		CSGSId* tx = new CSGSId(id, MESSAGE_DELAY, group_user, this);
 		tx->setLogoff();
 		m_ids[id] = tx;
 
 		return;
 	}
 
-	if (m_id != 0x00U) {
-		delete userData;
+	if (m_id != 0x00U)
 		return;
-	}
 
-	m_id = id;
+	setId(id);
 
 	// Change the Your callsign to CQCQCQ
 	header.setCQCQCQ();
@@ -451,41 +550,12 @@ void CGroupHandler::process(CHeaderData &header)
 	}
 
 	// Get the home repeater of the user, because we don't want to route this incoming back to him
-	std::string exclude;
-	if (userData) {
-		exclude = userData->getRepeater();
-		delete userData;	// it's gone now
-	}
+	CCallsign exclude;
+	if (isCached)
+		exclude = CCallsign(userData.getRepeater());
 
-	// Build new repeater list, based on users that are currently logged in
-	for (auto it = m_users.begin(); it != m_users.end(); ++it) {
-		CSGSUser *user = it->second;
-		if (user != NULL) {
-			// Find the user in the cache
-			userData = m_cache->findUser(user->getCallsign());
-
-			if (userData) {
-				// Check for the excluded repeater
-				if (userData->getRepeater().compare(exclude)) {
-					// Find the users repeater in the repeater list, add it otherwise
-					CSGSRepeater *repeater = m_repeaters[userData->getRepeater()];
-					if (repeater == NULL) {
-						// Add a new repeater entry
-						repeater = new CSGSRepeater;
-						// we zone rroute to all the repeaters, except for the sender who transmitted it
-						repeater->m_destination = std::string("/") + userData->getRepeater().substr(0, 6) + userData->getRepeater().back();
-						repeater->m_repeater    = userData->getRepeater();
-						repeater->m_gateway     = userData->getGateway();
-						repeater->m_address     = userData->getAddress();
-						m_repeaters[userData->getRepeater()] = repeater;
-					}
-				}
-
-				delete userData;
-				userData = NULL;
-			}
-		}
-	}
+	// we zone route to all the repeaters, except for the sender who transmitted it
+	startFanout(exclude);
 
 	switch (m_callsignSwitch) {
 		case SCS_GROUP_CALLSIGN:
@@ -510,9 +580,11 @@ void CGroupHandler::process(CAMBEData &data)
 {
 	unsigned int id = data.getId();
 
-	CSGSId* tx = m_ids[id];
-	if (tx == NULL)
+	// find(), so that frames don't insert empty entries
+	auto found = m_ids.find(id);
+	if (found == m_ids.end() || found->second == NULL)
 		return;
+	CSGSId* tx = found->second;
 
 	tx->reset();
 
@@ -536,12 +608,7 @@ void CGroupHandler::process(CAMBEData &data)
 					tx->setLogoff();
 
 					// Ensure that this user is in the cache in time for the logoff ack
-					CUserData* cacheUser = m_cache->findUser(user->getCallsign());
-					if (cacheUser == NULL)
-						m_irc->findUser(user->getCallsign());
-
-					delete cacheUser;
-					cacheUser = NULL;
+					m_lookup->request(user->getCallsign());
 				}
 				TEMP = text.substr(0, 4);
 				CUtils::ToUpper(TEMP);
@@ -549,12 +616,7 @@ void CGroupHandler::process(CAMBEData &data)
 					tx->setInfo();
 
 					// Ensure that this user is in the cache in time for the info text
-					CUserData* cacheUser = m_cache->findUser(user->getCallsign());
-					if (cacheUser == NULL)
-						m_irc->findUser(user->getCallsign());
-
-					delete cacheUser;
-					cacheUser = NULL;
+					m_lookup->request(user->getCallsign());
 				}
 			}
 		}
@@ -569,19 +631,15 @@ void CGroupHandler::process(CAMBEData &data)
 	}
 
 	if (data.isEnd()) {
-		if (id == m_id) {
-			// Clear the repeater list if we're the relayed id
-			for (auto it = m_repeaters.begin(); it != m_repeaters.end(); ++it)
-				delete it->second;
-			m_repeaters.clear();
-			m_id = 0x00U;
-		}
+		if (id == m_id)
+			setId(0x00U);
 
 		if (tx->isLogin()) {
 			tx->reset();
 			tx->setEnd();
 		} else if (tx->isLogoff()) {
-			m_users.erase(user->getCallsign());
+			releaseRepeater(user);
+			m_users.erase(user->getKey());
 			tx->reset();
 			tx->setEnd();
 		} else if (tx->isInfo()) {
@@ -609,18 +667,17 @@ bool CGroupHandler::logoff(const std::string &callsign)
 		for (auto it = m_ids.begin(); it != m_ids.end(); ++it)
 			delete it->second;
 
-		for (auto it = m_repeaters.begin(); it != m_repeaters.end(); ++it)
-			delete it->second;
-
 		m_users.clear();
 		m_ids.clear();
-		m_repeaters.clear();
+		clearRepeaters();
+		m_expiredUsers.clear();
 
-		m_id = 0x00U;
+		setId(0x00U);
 
 		return true;
 	} else {
-		CSGSUser* user = m_users[callsign];
+		CCallsign key(callsign);
+		CSGSUser* user = m_users[key];
 		if (user == NULL) {
 			printf("Invalid callsign asked to logoff");
 			return false;
@@ -634,7 +691,7 @@ bool CGroupHandler::logoff(const std::string &callsign)
 			CSGSId* id = it->second;
 			if (id != NULL && id->getUser() == user) {
 				if (id->getId() == m_id)
-					m_id = 0x00U;
+					setId(0x00U);
 
 				m_ids.erase(it);
 				delete id;
@@ -642,7 +699,9 @@ bool CGroupHandler::logoff(const std::string &callsign)
 			}
 		}
 
-		m_users.erase(callsign);
+		releaseRepeater(user);
+		m_users.erase(key);
+		m_expiredUsers.remove(user);
 		delete user;
 
 		// Check to see if we have any users left
@@ -652,13 +711,11 @@ bool CGroupHandler::logoff(const std::string &callsign)
 		if (count == 0U) {
 			for (auto it = m_ids.begin(); it != m_ids.end(); ++it)
 				delete it->second;
-			for (auto it = m_repeaters.begin(); it != m_repeaters.end(); ++it)
-				delete it->second;
 
 			m_ids.clear();
-			m_repeaters.clear();
+			clearRepeaters();
 
-			m_id = 0x00U;
+			setId(0x00U);
 		}
 
 		return true;
@@ -671,7 +728,7 @@ bool CGroupHandler::process(CHeaderData &header, DIRECTION, AUDIO_SOURCE)
 		return false;
 
 	std::string my = header.getMyCall1();
-	m_id = header.getId();
+	setId(header.getId());
 
 	m_linkTimer.start();
 
@@ -682,31 +739,7 @@ bool CGroupHandler::process(CHeaderData &header, DIRECTION, AUDIO_SOURCE)
 	header.setFlag2(0x00);
 	header.setFlag3(0x00);
 
-	// Build new repeater list
-	for (auto it = m_users.begin(); it != m_users.end(); ++it) {
-		CSGSUser* user = it->second;
-		if (user) {
-			// Find the user in the cache
-			CUserData* userData = m_cache->findUser(user->getCallsign());
-
-			if (userData) {
-				// Find the users repeater in the repeater list, add it otherwise
-				CSGSRepeater* repeater = m_repeaters[userData->getRepeater()];
-				if (repeater == NULL) {
-					// Add a new repeater entry
-					repeater = new CSGSRepeater;
-					repeater->m_destination = std::string("/") + userData->getRepeater().substr(0, 6) + userData->getRepeater().back();
-					repeater->m_repeater    = userData->getRepeater();
-					repeater->m_gateway     = userData->getGateway();
-					repeater->m_address     = userData->getAddress();
-					m_repeaters[userData->getRepeater()] = repeater;
-				}
-
-				delete userData;
-				userData = NULL;
-			}
-		}
-	}
+	startFanout(CCallsign());
 
 	switch (m_callsignSwitch) {
 		case SCS_GROUP_CALLSIGN:
@@ -721,7 +754,8 @@ bool CGroupHandler::process(CHeaderData &header, DIRECTION, AUDIO_SOURCE)
 			break;
 	}
 
-	CSGSId *tx = m_ids[m_id];
+	auto found = m_ids.find(m_id);
+	CSGSId *tx = (found == m_ids.end()) ? NULL : found->second;
 	if (tx) {
 		if (!tx->isLogin())
 			sendToRepeaters(header);
@@ -742,7 +776,8 @@ bool CGroupHandler::process(CAMBEData &data, DIRECTION, AUDIO_SOURCE)
 
 	m_linkTimer.start();
 
-	CSGSId *tx = m_ids[id];
+	auto found = m_ids.find(id);
+	CSGSId *tx = (found == m_ids.end()) ? NULL : found->second;
 	if (tx) {
 		if (!tx->isLogin())
 			sendToRepeaters(data);
@@ -751,12 +786,7 @@ bool CGroupHandler::process(CAMBEData &data, DIRECTION, AUDIO_SOURCE)
 
 	if (data.isEnd()) {
 		m_linkTimer.stop();
-		m_id = 0x00U;
-
-		// Clear the repeater list
-		for (auto it = m_repeaters.begin(); it != m_repeaters.end(); ++it)
-			delete it->second;
-		m_repeaters.clear();
+		setId(0x00U);
 	}
 
 	return true;
@@ -788,139 +818,127 @@ bool CGroupHandler::linkInt()
 	printf("Linking %s to %s reflector %s\n", m_repeater.c_str(), (LT_DEXTRA==m_linkType)?"DExtra":"DCS", m_linkReflector.c_str());
 
 	// Find the repeater to link to
-	CRepeaterData* data = m_cache->findRepeater(m_linkReflector);
-	if (data == NULL) {
-		printf("Cannot find the reflector in the cache, not linking\n");
+	CRepeaterData data;
+	m_linkPending = !m_cache->findRepeater(m_linkReflector, data);
+	if (m_linkPending) {
+		printf("Cannot find the reflector in the cache, not linking yet\n");
 		return false;
 	}
 
-	m_linkGateway = data->getGateway();
+	m_linkGateway = data.getGateway();
 	bool rtv = true;
 	switch (m_linkType) {
 		case LT_DEXTRA:
-			m_linkStatus  = LS_LINKING_DEXTRA;
-			CDExtraHandler::link(this, m_repeater, m_linkReflector, data->getAddress());
+			setLinkStatus(LS_LINKING_DEXTRA);
+			CDExtraHandler::link(this, m_repeater, m_linkReflector, data.getAddress());
 			break;
 		case LT_DCS:
-			m_linkStatus  = LS_LINKING_DCS;
-			CDCSHandler::link(this, m_repeater, m_linkReflector, data->getAddress());
+			setLinkStatus(LS_LINKING_DCS);
+			CDCSHandler::link(this, m_repeater, m_linkReflector, data.getAddress());
 			break;
 		default:
 			rtv = false;
 			break;
 	}
-	delete data;
 	return rtv;
 }
 
-void CGroupHandler::clockInt(unsigned int ms)
+void CGroupHandler::timerExpired(CWheelTimer &timer)
 {
-	m_linkTimer.clock(ms);
-	if (m_linkTimer.isRunning() && m_linkTimer.hasExpired()) {
-		m_linkTimer.stop();
-		m_id = 0x00U;
-
-		// Clear the repeater list
-		for (std::map<std::string, CSGSRepeater *>::iterator it = m_repeaters.begin(); it != m_repeaters.end(); ++it)
-			delete it->second;
-		m_repeaters.clear();
-	}
-	m_announceTimer.clock(ms);
-	if (m_announceTimer.hasExpired()) {
+	if (&timer == &m_linkTimer) {
+		setId(0x00U);
+	} else if (&timer == &m_announceTimer) {
 		m_irc->sendHeardWithTXMsg(m_groupCallsign, "    ", "CQCQCQ  ", m_repeater, m_gateway, 0x00U, 0x00U, 0x00U, std::string(""), m_infoText);
 		if (m_offCallsign.size() && m_offCallsign.compare("        "))
 			m_irc->sendHeardWithTXMsg(m_offCallsign, "    ", "CQCQCQ  ", m_repeater, m_gateway, 0x00U, 0x00U, 0x00U, std::string(""), m_infoText);
 		m_announceTimer.start(60U * 60U);		// 1 hour
+	} else if (&timer == &m_infoTimer) {
+		// Keep trying once a second until QuadNet can be told about the new link status
+		if (m_oldlinkStatus != m_linkStatus) {
+			if (7 == m_irc->getConnectionState()) {
+				updateReflectorInfo();
+				m_oldlinkStatus = m_linkStatus;
+			} else
+				m_infoTimer.start();
+		}
+	} else if (&timer == &m_reportTimer) {
+		reportDueUsers();
+	} else if (&timer == &m_expiryTimer) {
+		// Don't do timeouts when relaying audio
+		if (m_id != 0x00U) {
+			m_expiryTimer.start();
+			return;
+		}
 
+		while (m_expiredUsers.size()) {
+			CSGSUser *user = m_expiredUsers.front();
+			m_expiredUsers.pop_front();
+			userExpired(user);
+		}
 	}
-	if (m_oldlinkStatus!=m_linkStatus && 7==m_irc->getConnectionState()) {
-		updateReflectorInfo();
-		m_oldlinkStatus = m_linkStatus;
-	}
+}
 
-	// For each incoming id
-	for (auto it = m_ids.begin(); it != m_ids.end(); ++it) {
-		CSGSId* tx = it->second;
-
-		if (tx != NULL && tx->clock(ms)) {
-			std::string callsign = tx->getUser()->getCallsign();
-
-			if (tx->isEnd()) {
-				CUserData* user = m_cache->findUser(callsign);
-				if (user) {
-					if (tx->isLogin()) {
-						sendAck(*user, "Logged in");
-					} else if (tx->isInfo()) {
-						sendAck(*user, m_infoText);
-					} else if (tx->isLogoff()) {
-						sendAck(*user, "Logged off");
-					}
-
-					delete user;
-					user = NULL;
-				} else {
-					printf("Cannot find %s in the cache", callsign.c_str());
-				}
+void CGroupHandler::userExpired(CSGSUser *user)
+{
+	// Ignore users who have already been removed, or who have been heard since
+	auto it = m_users.find(user->getKey());
+	if (it == m_users.end() || it->second != user || !user->hasExpired())
+		return;
 
-				delete tx;
-				m_ids.erase(it);
+	// Don't do timeouts when relaying audio
+	if (m_id != 0x00U) {
+		m_expiredUsers.push_back(user);
+		if (!m_expiryTimer.isRunning())
+			m_expiryTimer.start();
+		return;
+	}
 
-				// The iterator is now invalid, so we'll find the next expiry on the next clock tick with a
-				// new iterator
-				break;
-			} else {
-				if (tx->getId() == m_id) {
-					// Clear the repeater list if we're the relayed id
-					for (std::map<std::string, CSGSRepeater *>::iterator it = m_repeaters.begin(); it != m_repeaters.end(); ++it)
-						delete it->second;
-					m_repeaters.clear();
-					m_id = 0x00U;
-				}
+	printf("Removing %s from Smart Group %s, user timeout\n", user->getCallsign().c_str(), m_groupCallsign.c_str());
 
-				if (tx->isLogin()) {
-					tx->reset();
-					tx->setEnd();
-				} else if (tx->isLogoff()) {
-					m_users.erase(callsign);
-					tx->reset();
-					tx->setEnd();
-				} else if (tx->isInfo()) {
-					tx->reset();
-					tx->setEnd();
-				} else {
-					delete tx;
-					m_ids.erase(it);
-					// The iterator is now invalid, so we'll find the next expiry on the next clock tick with a
-					// new iterator
-					break;
-				}
+	logUser(LU_OFF, m_groupCallsign, user->getCallsign());	// inform QuadNet
+	releaseRepeater(user);
+	m_users.erase(it);
+	delete user;
+}
+
+void CGroupHandler::idExpired(CSGSId *tx)
+{
+	std::string callsign = tx->getUser()->getCallsign();
+
+	if (tx->isEnd()) {
+		CUserData user;
+		if (m_cache->findUser(callsign, user)) {
+			if (tx->isLogin()) {
+				sendAck(user, "Logged in");
+			} else if (tx->isInfo()) {
+				sendAck(user, m_infoText);
+			} else if (tx->isLogoff()) {
+				sendAck(user, "Logged off");
 			}
+		} else {
+			printf("Cannot find %s in the cache", callsign.c_str());
 		}
-	}
-
-	// Individual user expiry, but not for the permanent entries
-	for (auto it = m_users.begin(); it != m_users.end(); ++it) {
-		CSGSUser* user = it->second;
-		if (user && m_permanent.find(user->getCallsign()) == m_permanent.end())
-			user->clock(ms);
-	}
 
-	// Don't do timeouts when relaying audio
-	if (m_id != 0x00U)
-		return;
+		m_ids.erase(tx->getId());
+		delete tx;
+	} else {
+		if (tx->getId() == m_id)
+			setId(0x00U);
 
-	// Individual user expiry
-	for (auto it = m_users.begin(); it != m_users.end(); ++it) {
-		CSGSUser* user = it->second;
-		if (user && user->hasExpired()) {
-			printf("Removing %s from Smart Group %s, user timeout\n", user->getCallsign().c_str(), m_groupCallsign.c_str());
-
-			logUser(LU_OFF, m_groupCallsign, user->getCallsign());	// inform QuadNet
-			delete user;
-			m_users.erase(it);
-			// The iterator is now invalid, so we'll find the next expiry on the next clock tick with a
-			// new iterator
-			break;
+		if (tx->isLogin()) {
+			tx->reset();
+			tx->setEnd();
+		} else if (tx->isLogoff()) {
+			releaseRepeater(tx->getUser());
+			m_users.erase(tx->getUser()->getKey());
+			tx->reset();
+			tx->setEnd();
+		} else if (tx->isInfo()) {
+			tx->reset();
+			tx->setEnd();
+		} else {
+			m_ids.erase(tx->getId());
+			delete tx;
 		}
 	}
 }
@@ -964,44 +982,273 @@ void CGroupHandler::updateReflectorInfo()
 	m_irc->sendSGSInfo(subcommand, parms);
 }
 
-void CGroupHandler::logUser(LOGUSER lu, const std::string channel, const std::string user)
+void CGroupHandler::logUser(LOGUSER lu, const std::string &channel, const std::string &user)
 {
-	std::string cmd(LU_OFF==lu ? "LOGOFF" : "LOGON");
-	std::string chn(channel);
-	std::string usr(user);
-	CUtils::ReplaceChar(chn, ' ', '_');
-	CUtils::ReplaceChar(usr, ' ', '_');
-	std::vector<std::string> parms;
-	parms.push_back(chn);
-	parms.push_back(usr);
-	m_irc->sendSGSInfo(cmd, parms);
+	m_sgsInfo.assign(LU_OFF==lu ? "LOGOFF" : "LOGON");
+	for (const std::string *param : { &channel, &user }) {
+		m_sgsInfo.push_back(' ');
+		for (auto c : *param)
+			m_sgsInfo.push_back(' ' == c ? '_' : c);
+	}
+	m_irc->sendSGSInfo(m_sgsInfo);
 }
 
-void CGroupHandler::sendToRepeaters(CHeaderData& header) const
+// A LOGON update, held back if QuadNet heard about this user within the window
+void CGroupHandler::reportUser(CSGSUser *user)
 {
-	for (auto it = m_repeaters.begin(); it != m_repeaters.end(); ++it) {
-		CSGSRepeater* repeater = it->second;
-		if (repeater != NULL) {
-			header.setYourCall(repeater->m_destination);
-			header.setDestination(repeater->m_address, G2_DV_PORT);
-			header.setRepeaters(repeater->m_gateway, repeater->m_repeater);
-			m_g2Handler->writeHeader(header);
+	if (user->report(::time(NULL), m_reportWindow)) {
+		logUser(LU_ON, m_groupCallsign, user->getCallsign());
+		return;
+	}
+
+	// The group's one timer runs to the earliest end of a held back user's window
+	unsigned int wait = (unsigned int)(user->getReportTime(m_reportWindow) - ::time(NULL));
+	if (!m_reportTimer.isRunning() || wait < m_reportTimer.getRemaining())
+		m_reportTimer.start(wait);
+}
+
+// Send the updates whose windows have ended, and wait for the next one
+void CGroupHandler::reportDueUsers()
+{
+	time_t now  = ::time(NULL);
+	time_t next = 0;
+
+	for (auto it = m_users.begin(); it != m_users.end(); ++it) {
+		CSGSUser *user = it->second;
+		if (user == NULL || !user->isReportDue())
+			continue;
+
+		time_t due = user->getReportTime(m_reportWindow);
+		if (due <= now) {
+			logUser(LU_ON, m_groupCallsign, user->getCallsign());
+			user->setReported(now);
+		} else if (0 == next || due < next)
+			next = due;
+	}
+
+	if (next != 0)
+		m_reportTimer.start((unsigned int)(next - now));
+}
+
+void CGroupHandler::setLinkStatus(LINK_STATUS status)
+{
+	m_linkStatus = status;
+
+	// QuadNet is told about the change from the timer
+	if (m_oldlinkStatus != m_linkStatus)
+		m_infoTimer.start();
+}
+
+// Point the user at the repeater the cache has for them now
+void CGroupHandler::resolveUser(CSGSUser *user)
+{
+	CUserData userData;
+	if (!m_cache->findUser(user->getCallsign(), userData))
+		return;		// keep whatever we had
+
+	setUserRepeater(user, userData);
+}
+
+void CGroupHandler::setUserRepeater(CSGSUser *user, const CUserData &userData)
+{
+	std::string callsign = userData.getRepeater();
+	CCallsign rpt(callsign);
+
+	auto it = m_repeaters.find(rpt);
+	if (user->getRepeater() != rpt || m_repeaters.end() == it) {
+		releaseRepeater(user);
+
+		it = m_repeaters.find(rpt);
+		if (m_repeaters.end() == it) {
+			CSGSRepeater *repeater = new CSGSRepeater;
+			repeater->m_destination = std::string("/") + callsign.substr(0, 6) + callsign.back();
+			repeater->m_repeater    = callsign;
+			repeater->m_port        = G2_DV_PORT;
+			repeater->m_users       = 0U;
+			it = m_repeaters.insert(std::make_pair(rpt, repeater)).first;
 		}
+
+		it->second->m_users++;
+		user->setRepeater(rpt);
 	}
+
+	CSGSRepeater *repeater = it->second;
+
+	// only serialize the header again if the repeater has moved to another gateway
+	if (repeater->m_gateway.empty() || repeater->m_gateway.compare(userData.getGateway()))
+		setRepeaterGateway(repeater, userData.getGateway());
+	repeater->m_address = userData.getAddress();
 }
 
-void CGroupHandler::sendToRepeaters(CAMBEData &data) const
+// The user has gone, and the repeater goes too if they were the last one there
+void CGroupHandler::releaseRepeater(CSGSUser *user)
 {
-	for (auto it = m_repeaters.begin(); it != m_repeaters.end(); ++it) {
-		CSGSRepeater* repeater = it->second;
-		if (repeater != NULL) {
-			data.setDestination(repeater->m_address, G2_DV_PORT);
-			m_g2Handler->writeAMBE(data);
+	if (user == NULL || user->getRepeater().isBlank())
+		return;
+
+	auto it = m_repeaters.find(user->getRepeater());
+	if (m_repeaters.end() != it && 0U == --it->second->m_users) {
+		unindexRepeater(it->second);
+		delete it->second;
+		m_repeaters.erase(it);
+	}
+
+	user->setRepeater(CCallsign());
+}
+
+void CGroupHandler::refreshRepeater(CSGSRepeater *repeater)
+{
+	CRepeaterData data;
+	if (!m_cache->findRepeater(repeater->m_repeater, data))
+		return;
+
+	if (repeater->m_gateway.compare(data.getGateway()))
+		setRepeaterGateway(repeater, data.getGateway());
+	repeater->m_address = data.getAddress();
+}
+
+// Keeps m_gateways in step as the repeater moves to another gateway
+void CGroupHandler::setRepeaterGateway(CSGSRepeater *repeater, const std::string &gateway)
+{
+	unindexRepeater(repeater);
+
+	repeater->m_gateway = gateway;
+	repeater->m_header.build(repeater->m_destination, repeater->m_gateway, repeater->m_repeater);
+
+	if (gateway.size())
+		m_gateways.insert(std::make_pair(CCallsign(gateway), repeater));
+}
+
+void CGroupHandler::unindexRepeater(CSGSRepeater *repeater)
+{
+	if (repeater->m_gateway.empty())
+		return;
+
+	auto range = m_gateways.equal_range(CCallsign(repeater->m_gateway));
+	for (auto it = range.first; it != range.second; ++it) {
+		if (it->second == repeater) {
+			m_gateways.erase(it);
+			return;
+		}
+	}
+}
+
+// Called for every reply in a SENDLIST burst, so only indexed lookups here
+void CGroupHandler::cacheUpdated(const std::string &user, const std::string &repeater, const std::string &gateway)
+{
+	CCallsign usr(user), rpt(repeater), gw(gateway);
+	std::vector<CSGSRepeater *> matched;
+
+	for (auto it=m_Groups.begin(); it!=m_Groups.end(); it++) {
+		CGroupHandler *group = *it;
+
+		if (user.size()) {
+			auto found = group->m_users.find(usr);
+			if (group->m_users.end() != found && found->second != NULL)
+				group->resolveUser(found->second);
+		}
+
+		CSGSRepeater *refreshed = NULL;
+		if (repeater.size()) {
+			auto found = group->m_repeaters.find(rpt);
+			if (group->m_repeaters.end() != found) {
+				refreshed = found->second;
+				group->refreshRepeater(refreshed);
+			}
+		}
+
+		// refreshRepeater() can move a repeater to another gateway, so find them all first
+		if (gateway.size()) {
+			matched.clear();
+			auto range = group->m_gateways.equal_range(gw);
+			for (auto rit = range.first; rit != range.second; ++rit) {
+				if (rit->second != refreshed)
+					matched.push_back(rit->second);
+			}
+			for (auto rit = matched.begin(); rit != matched.end(); ++rit)
+				group->refreshRepeater(*rit);
+		}
+	}
+}
+
+// Keep the stream id routing table in step with the group's current stream
+void CGroupHandler::setId(unsigned int id)
+{
+	if (m_id != 0x00U) {
+		auto it = m_idIndex.find(m_id);
+		if (m_idIndex.end() != it && it->second == this)
+			m_idIndex.erase(it);
+	}
+
+	m_id = id;
+
+	if (m_id != 0x00U)
+		m_idIndex[m_id] = this;
+}
+
+// Everybody has gone
+void CGroupHandler::clearRepeaters()
+{
+	for (auto it = m_repeaters.begin(); it != m_repeaters.end(); ++it)
+		delete it->second;
+	m_repeaters.clear();
+	m_gateways.clear();
+	m_fanout.reset();
+}
+
+// The repeaters a stream goes to are frozen when it starts
+void CGroupHandler::startFanout(const CCallsign &exclude)
+{
+	m_exclude = exclude;
+	m_fanout.reset();
+}
+
+// Subscribers may come and go during a stream, but the repeaters it goes to don't change
+const std::shared_ptr<const CSGSFanout> &CGroupHandler::getFanout()
+{
+	if (!m_fanout) {
+		CSGSFanout *fanout = new CSGSFanout;
+		for (auto it = m_repeaters.begin(); it != m_repeaters.end(); ++it) {
+			if (it->first != m_exclude) {
+				fanout->m_repeaters.push_back(*it->second);
+				// the portmap belongs to this thread, so look the port up here
+				fanout->m_repeaters.back().m_port = m_g2Handler->getPort(it->second->m_address, G2_DV_PORT);
+				fanout->m_destinations.push_back(m_g2Handler->getDestination(it->second->m_address, G2_DV_PORT));
+			}
 		}
+		m_fanout.reset(fanout);
 	}
+
+	return m_fanout;
+}
+
+void CGroupHandler::sendToRepeaters(CHeaderData& header)
+{
+	if (m_worker) {
+		m_worker->writeHeader(getFanout(), header);
+		return;
+	}
+
+	const std::shared_ptr<const CSGSFanout> &fanout = getFanout();
+
+	unsigned char buffer[60U];
+	for (auto it = fanout->m_repeaters.begin(); it != fanout->m_repeaters.end(); ++it) {
+		unsigned int length = it->m_header.getG2Data(header, buffer, 60U);
+		m_g2Handler->writeHeader(buffer, length, it->m_address, it->m_port);
+	}
+}
+
+void CGroupHandler::sendToRepeaters(CAMBEData &data)
+{
+	if (m_worker) {
+		m_worker->writeAMBE(getFanout(), data);
+		return;
+	}
+
+	m_g2Handler->writeAMBE(data, getFanout()->m_destinations);
 }
 
-void CGroupHandler::sendFromText(const std::string &my) const
+void CGroupHandler::sendFromText(const std::string &my)
 {
 	std::string text;
 	switch (m_callsignSwitch) {
@@ -1091,7 +1338,7 @@ void CGroupHandler::linkUp(DSTAR_PROTOCOL, const std::string &callsign)
 {
 	printf("%s link to %s established\n", (LT_DEXTRA==m_linkType)?"DExtra":"DCS", callsign.c_str());
 
-	m_linkStatus = (LT_DEXTRA == m_linkType) ? LS_LINKED_DEXTRA : LS_LINKED_DCS;
+	setLinkStatus((LT_DEXTRA == m_linkType) ? LS_LINKED_DEXTRA : LS_LINKED_DCS);
 }
 
 bool CGroupHandler::linkFailed(DSTAR_PROTOCOL, const std::string &callsign, bool isRecoverable)
@@ -1099,7 +1346,7 @@ bool CGroupHandler::linkFailed(DSTAR_PROTOCOL, const std::string &callsign, bool
 	if (!isRecoverable) {
 		if (m_linkStatus != LS_NONE) {
 			printf("%s link to %s has failed\n", (LT_DEXTRA==m_linkType)?"DExtra":"DCS", callsign.c_str());
-			m_linkStatus = LS_NONE;
+			setLinkStatus(LS_NONE);
 		}
 
 		return false;
@@ -1107,7 +1354,7 @@ bool CGroupHandler::linkFailed(DSTAR_PROTOCOL, const std::string &callsign, bool
 
 	if (m_linkStatus == LS_LINKING_DEXTRA || m_linkStatus == LS_LINKED_DEXTRA || m_linkStatus == LS_LINKING_DCS || m_linkStatus == LS_LINKED_DCS) {
 		printf("%s link to %s has failed, relinking\n", (LT_DEXTRA==m_linkType)?"DExtra":"DCS", callsign.c_str());
-		m_linkStatus = (LT_DEXTRA == m_linkType) ? LS_LINKING_DEXTRA : LS_LINKING_DCS;
+		setLinkStatus((LT_DEXTRA == m_linkType) ? LS_LINKING_DEXTRA : LS_LINKING_DCS);
 		return true;
 	}
 
@@ -1118,7 +1365,7 @@ void CGroupHandler::linkRefused(DSTAR_PROTOCOL, const std::string &callsign)
 {
 	if (m_linkStatus != LS_NONE) {
 		printf("%s link to %s was refused\n", (LT_DEXTRA==m_linkType)?"DExtra":"DCS", callsign.c_str());
-		m_linkStatus = LS_NONE;
+		setLinkStatus(LS_NONE);
 	}
 }
 
@@ -20,49 +20,74 @@
 #pragma once
 
 #include <netinet/in.h>
+#include <ctime>
 #include <string>
 #include <map>
+#include <unordered_map>
 #include <list>
 #include <set>
+#include <memory>
+#include <vector>
 
 #include "RemoteGroup.h"
 #include "G2ProtocolHandler.h"
+#include "G2HeaderTemplate.h"
 #include "ReflectorCallback.h"		// DEXTRA_LINK || DCS_LINK
 #include "RepeaterCallback.h"
 #include "TextCollector.h"
+#include "TimerWheel.h"
 #include "CacheManager.h"
+#include "Callsign.h"
 #include "DStarDefines.h"
 #include "HeaderData.h"
 #include "AMBEData.h"
 #include "IRCDDB.h"
-#include "Timer.h"
+#include "UserLookup.h"
 
 enum LOGUSER {
 	LU_ON,
 	LU_OFF
 };
 
-class CSGSUser {
+class CGroupHandler;
+class CGroupWorker;
+
+class CSGSUser : public ITimerCallback {
 public:
-	CSGSUser(const std::string& callsign, unsigned int timeout);
+	CSGSUser(const std::string& callsign, unsigned int timeout, bool permanent, CGroupHandler *group);
 	~CSGSUser();
 
 	void reset();
 
-	bool clock(unsigned int ms);
-	bool hasExpired();
+	bool hasExpired() const;
 
 	std::string getCallsign() const;
-	CTimer getTimer() const;
+	const CCallsign &getKey() const;
+	const CWheelTimer &getTimer() const;
+
+	const CCallsign &getRepeater() const;
+	void setRepeater(const CCallsign &repeater);
+
+	bool report(time_t now, unsigned int window);
+	bool isReportDue() const;
+	time_t getReportTime(unsigned int window) const;	// when its window ends
+	void setReported(time_t now);
+
+	virtual void timerExpired(CWheelTimer &timer);
 
 private:
-	std::string m_callsign;
-	CTimer m_timer;
+	CCallsign      m_callsign;
+	bool           m_permanent;
+	CGroupHandler *m_group;
+	CWheelTimer    m_timer;
+	CCallsign      m_repeater;		// where the cache last put this user, blank if we don't know
+	time_t         m_reported;		// when QuadNet was last told about this user
+	bool           m_reportDue;		// heard since then
 };
 
-class CSGSId {
+class CSGSId : public ITimerCallback {
 public:
-	CSGSId(unsigned int id, unsigned int timeout, CSGSUser* user);
+	CSGSId(unsigned int id, unsigned int timeout, CSGSUser* user, CGroupHandler *group);
 	~CSGSId();
 
 	unsigned int getId() const;
@@ -74,8 +99,7 @@ public:
 	void setLogoff();
 	void setEnd();
 
-	bool clock(unsigned int ms);
-	bool hasExpired();
+	virtual void timerExpired(CWheelTimer &timer);
 
 	bool isLogin() const;
 	bool isInfo() const;
@@ -88,7 +112,8 @@ public:
 
 private:
 	unsigned int   m_id;
-	CTimer         m_timer;
+	CGroupHandler *m_group;
+	CWheelTimer    m_timer;
 	bool           m_login;
 	bool           m_info;
 	bool           m_logoff;
@@ -103,18 +128,38 @@ public:
 	std::string        m_repeater;
 	std::string        m_gateway;
 	in_addr            m_address;
+	unsigned int       m_port;
+	CG2HeaderTemplate  m_header;	// built from the three callsigns above
+	unsigned int       m_users;		// how many subscribers are at this repeater
+};
+
+// The repeaters that one stream is sent to, frozen when the stream starts
+class CSGSFanout {
+public:
+	std::vector<CSGSRepeater> m_repeaters;
+	std::vector<sockaddr_in>  m_destinations;	// the same repeaters, ready for sendmmsg()
 };
 
-class CGroupHandler : public IReflectorCallback {
+class CGroupHandler : public IReflectorCallback, public ITimerCallback {
 public:
 	static void add(const std::string &callsign, const std::string &logoff, const std::string &repeater, const std::string &infoText, const std::string &permanent,
 										unsigned int userTimeout, CALLSIGN_SWITCH callsignSwitch, bool txMsgSwitch, const std::string & eflector);
 	static void setG2Handler(CG2ProtocolHandler *handler);
 	static void setIRC(CIRCDDB *irc);
 	static void setCache(CCacheManager *cache);
+	static void setLookup(CUserLookup *lookup);
+	static void setReportWindow(unsigned int window);
 	static void setGateway(const std::string &gateway);
+	static void setWorkers(const std::vector<CGroupWorker *> &workers);
 	static void link();
 
+	// Links the groups whose reflectors weren't in the cache when they first
+	// tried, true while any are still waiting
+	static bool relink();
+
+	// The cache has new information about a user, repeater or gateway, any may be empty
+	static void cacheUpdated(const std::string &user, const std::string &repeater, const std::string &gateway);
+
 	static std::list<std::string> listGroups();
 
 	static CGroupHandler *findGroup(const std::string &callsign);
@@ -123,8 +168,6 @@ public:
 
 	static void finalise();
 
-	static void clock(unsigned int ms);
-
 	void process(CHeaderData &header);
 	void process(CAMBEData &data);
 	bool remoteLink(const std::string &reflector);
@@ -146,21 +189,30 @@ public:
 
 	virtual bool singleHeader();
 
+	virtual void timerExpired(CWheelTimer &timer);
+
+	void userExpired(CSGSUser *user);
+	void idExpired(CSGSId *tx);
+
 protected:
 	CGroupHandler(const std::string &callsign, const std::string &logoff, const std::string &repeater, const std::string &infoText, const std::string &permanent,
 												unsigned int userTimeout, CALLSIGN_SWITCH callsignSwitch, bool txMsgSwitch, const std::string &reflector);
 	virtual ~CGroupHandler();
 
 	bool linkInt();
-	void clockInt(unsigned int ms);
 
 private:
 	static std::list<CGroupHandler *> m_Groups;
+	static std::unordered_map<std::string, CGroupHandler *>  m_callsignIndex;	// subscribe and unsubscribe callsigns
+	static std::unordered_map<unsigned int, CGroupHandler *> m_idIndex;			// the G2 stream each group is relaying
 
 	static CG2ProtocolHandler *m_g2Handler;
 	static CIRCDDB            *m_irc;
 	static CCacheManager      *m_cache;
+	static CUserLookup        *m_lookup;
 	static std::string         m_gateway;
+	static unsigned int        m_reportWindow;	// seconds over which a user's LOGON updates are coalesced
+	static std::string         m_sgsInfo;		// reused for every message to QuadNet
 
 	static std::string         m_name;
 
@@ -170,27 +222,51 @@ private:
 	std::string    m_shortCallsign;
 	std::string    m_repeater;
 	std::string    m_infoText;
-	std::set<std::string>  m_permanent;
+	std::set<CCallsign>  m_permanent;
 	std::string    m_linkReflector;
 	std::string    m_linkGateway;
 	LINK_STATUS    m_linkStatus;
 	LINK_STATUS    m_oldlinkStatus;
-	CTimer         m_linkTimer;
+	CWheelTimer    m_linkTimer;
+	CWheelTimer    m_infoTimer;
 	DSTAR_LINKTYPE m_linkType;
+	bool           m_linkPending;	// the reflector wasn't in the cache
 
 	unsigned int   m_id;
-	CTimer         m_announceTimer;
+	CWheelTimer    m_announceTimer;
+	CWheelTimer    m_expiryTimer;
+	CWheelTimer    m_reportTimer;
 	unsigned int   m_userTimeout;
 	CALLSIGN_SWITCH  m_callsignSwitch;
 	bool             m_txMsgSwitch;
 
 	std::map<unsigned int, CSGSId *>      m_ids;
-	std::map<std::string, CSGSUser *>     m_users;
-	std::map<std::string, CSGSRepeater *> m_repeaters;
-
-	void sendFromText(const std::string &text) const;
-	void sendToRepeaters(CHeaderData &header) const;
-	void sendToRepeaters(CAMBEData &data) const;
+	std::map<CCallsign, CSGSUser *>       m_users;
+	std::map<CCallsign, CSGSRepeater *>   m_repeaters;		// where the subscribers are, kept up to date as they come, go and move
+	std::multimap<CCallsign, CSGSRepeater *> m_gateways;	// the same repeaters by their current gateway
+	std::list<CSGSUser *>                 m_expiredUsers;	// timed out while we were relaying
+
+	// When the fan-out is sharded, the worker that sends this group's frames
+	CGroupWorker  *m_worker;
+	std::shared_ptr<const CSGSFanout> m_fanout;
+	CCallsign      m_exclude;		// the repeater the current stream came from
+
+	void sendFromText(const std::string &text);
+	void sendToRepeaters(CHeaderData &header);
+	void sendToRepeaters(CAMBEData &data);
+	const std::shared_ptr<const CSGSFanout> &getFanout();
 	void sendAck(const CUserData &user, const std::string &text) const;
-	void logUser(LOGUSER lu, const std::string channel, const std::string user);
+	void logUser(LOGUSER lu, const std::string &channel, const std::string &user);
+	void reportUser(CSGSUser *user);
+	void reportDueUsers();
+	void setLinkStatus(LINK_STATUS status);
+	void resolveUser(CSGSUser *user);
+	void setUserRepeater(CSGSUser *user, const CUserData &userData);
+	void setRepeaterGateway(CSGSRepeater *repeater, const std::string &gateway);
+	void unindexRepeater(CSGSRepeater *repeater);
+	void releaseRepeater(CSGSUser *user);
+	void refreshRepeater(CSGSRepeater *repeater);
+	void startFanout(const CCallsign &exclude);
+	void clearRepeaters();
+	void setId(unsigned int id);
 };
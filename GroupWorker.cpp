@@ -0,0 +1,163 @@
+/*
+ *   Copyright (c) 2018 by Thomas A. Early N7TAE
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation; either version 2 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+
+
+#include <cassert>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+
+#include "GroupWorker.h"
+#include "Defs.h"
+
+const unsigned int FANOUT_RING_SIZE = 1024U;	// about 20 seconds of voice for one busy group
+
+CFanoutJob::CFanoutJob() :
+m_type(FT_NONE),
+m_fanout(),
+m_header(),
+m_length(0U)
+{
+}
+
+CGroupWorker::CGroupWorker(unsigned int index, CG2ProtocolHandler *handler) :
+m_index(index),
+m_g2Handler(handler),
+m_ring(FANOUT_RING_SIZE),
+m_killed(false),
+m_sleeping(false),
+m_mutex(),
+m_cond(),
+m_future(),
+m_queued(0UL),
+m_dropped(0UL)
+{
+	assert(handler != NULL);
+}
+
+CGroupWorker::~CGroupWorker()
+{
+}
+
+void CGroupWorker::start()
+{
+	m_future = std::async(std::launch::async, &CGroupWorker::Entry, this);
+}
+
+void CGroupWorker::stop()
+{
+	m_killed = true;
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_cond.notify_one();
+	}
+	if (m_future.valid())
+		m_future.get();
+
+	printf("Worker %u: %lu frames queued, %lu dropped\n", m_index, m_queued, m_dropped);
+}
+
+unsigned int CGroupWorker::getIndex() const
+{
+	return m_index;
+}
+
+void CGroupWorker::writeHeader(const std::shared_ptr<const CSGSFanout> &fanout, const CHeaderData &header)
+{
+	CFanoutJob job;
+	job.m_type      = FT_HEADER;
+	job.m_fanout    = fanout;
+	job.m_header    = header;
+
+	post(job);
+}
+
+void CGroupWorker::writeAMBE(const std::shared_ptr<const CSGSFanout> &fanout, const CAMBEData &data)
+{
+	CFanoutJob job;
+	job.m_type      = FT_AMBE;
+	job.m_fanout    = fanout;
+	// The frame is the same for every repeater, so it is only encoded once
+	job.m_length    = data.getG2Data(job.m_data, 40U);
+
+	post(job);
+}
+
+void CGroupWorker::post(CFanoutJob &job)
+{
+	if (!m_ring.push(job)) {
+		// The worker can't keep up, it's better to lose a frame than to stall every other group
+		m_dropped++;
+		return;
+	}
+
+	m_queued++;
+
+	// Pairs with the fence in Entry(), so a sleeping worker can't miss this job
+	std::atomic_thread_fence(std::memory_order_seq_cst);
+	if (m_sleeping) {
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_cond.notify_one();
+	}
+}
+
+void CGroupWorker::Entry()
+{
+	printf("Starting worker %u\n", m_index);
+
+	CFanoutJob job;
+	for (;;) {
+		while (m_ring.pop(job)) {
+			fanout(job);
+			job.m_fanout.reset();
+		}
+
+		if (m_killed)
+			break;
+
+		std::unique_lock<std::mutex> lock(m_mutex);
+		m_sleeping = true;
+		std::atomic_thread_fence(std::memory_order_seq_cst);
+		if (m_ring.isEmpty() && !m_killed)
+			m_cond.wait_for(lock, std::chrono::milliseconds(MAX_WAIT_MS));
+		m_sleeping = false;
+	}
+
+	printf("Stopping worker %u\n", m_index);
+}
+
+void CGroupWorker::fanout(CFanoutJob &job)
+{
+	switch (job.m_type) {
+		case FT_HEADER: {
+			unsigned char buffer[60U];
+			for (auto it = job.m_fanout->m_repeaters.begin(); it != job.m_fanout->m_repeaters.end(); ++it) {
+				unsigned int length = it->m_header.getG2Data(job.m_header, buffer, 60U);
+				m_g2Handler->writeHeader(buffer, length, it->m_address, it->m_port);
+			}
+			break;
+		}
+
+		case FT_AMBE:
+			m_g2Handler->write(job.m_data, job.m_length, job.m_fanout->m_destinations);
+			break;
+
+		default:
+			break;
+	}
+}
@@ -0,0 +1,85 @@
+/*
+ *   Copyright (c) 2018 by Thomas A. Early N7TAE
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation; either version 2 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+
+
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "G2ProtocolHandler.h"
+#include "GroupHandler.h"
+#include "HeaderData.h"
+#include "AMBEData.h"
+#include "SPSCRing.h"
+
+enum FANOUT_TYPE {
+	FT_NONE,
+	FT_HEADER,
+	FT_AMBE
+};
+
+// One unit of work for a worker: a frame and the repeaters it goes to.
+// The repeater list is frozen for the whole stream and shared with the group.
+class CFanoutJob {
+public:
+	CFanoutJob();
+
+	FANOUT_TYPE    m_type;
+	std::shared_ptr<const CSGSFanout> m_fanout;
+	CHeaderData    m_header;		// FT_HEADER, copied into the ring slot
+	unsigned char  m_data[40U];		// FT_AMBE, already G2 encoded
+	unsigned int   m_length;
+};
+
+// A thread that sends the frames of the Smart Groups it owns to their repeaters.
+// The routing thread is the only producer, so each worker has an SPSC ring.
+class CGroupWorker {
+public:
+	CGroupWorker(unsigned int index, CG2ProtocolHandler *handler);
+	~CGroupWorker();
+
+	void start();
+	void stop();
+
+	// Called from the routing thread only
+	void writeHeader(const std::shared_ptr<const CSGSFanout> &fanout, const CHeaderData &header);
+	void writeAMBE(const std::shared_ptr<const CSGSFanout> &fanout, const CAMBEData &data);
+
+	unsigned int getIndex() const;
+
+private:
+	unsigned int             m_index;
+	CG2ProtocolHandler      *m_g2Handler;
+	CSPSCRing<CFanoutJob>    m_ring;
+	std::atomic<bool>        m_killed;
+	std::atomic<bool>        m_sleeping;
+	std::mutex               m_mutex;
+	std::condition_variable  m_cond;
+	std::future<void>        m_future;
+	unsigned long            m_queued;
+	unsigned long            m_dropped;
+
+	void Entry();
+	void post(CFanoutJob &job);
+	void fanout(CFanoutJob &job);
+};
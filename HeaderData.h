@@ -23,6 +23,8 @@
 
 #include <netinet/in.h>
 
+#include "DStarDefines.h"
+
 class CHeaderData {
 public:
 	CHeaderData();
@@ -112,11 +114,11 @@ private:
 	unsigned char  m_flag1;
 	unsigned char  m_flag2;
 	unsigned char  m_flag3;
-	unsigned char* m_myCall1;
-	unsigned char* m_myCall2;
-	unsigned char* m_yourCall;
-	unsigned char* m_rptCall1;
-	unsigned char* m_rptCall2;
+	unsigned char  m_myCall1[LONG_CALLSIGN_LENGTH];
+	unsigned char  m_myCall2[SHORT_CALLSIGN_LENGTH];
+	unsigned char  m_yourCall[LONG_CALLSIGN_LENGTH];
+	unsigned char  m_rptCall1[LONG_CALLSIGN_LENGTH];
+	unsigned char  m_rptCall2[LONG_CALLSIGN_LENGTH];
 	in_addr        m_yourAddress;
 	unsigned int   m_yourPort;
 	unsigned int   m_myPort;
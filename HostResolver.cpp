@@ -0,0 +1,171 @@
+/*
+ *   Copyright (c) 2018 by Thomas A. Early N7TAE
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation; either version 2 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+
+
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <netdb.h>
+#include <sys/socket.h>
+#include <arpa/inet.h>
+
+#include "HostResolver.h"
+
+// Enough to hide a slow resolver without flooding it
+const unsigned int RESOLVER_THREADS = 8U;
+
+CHostResolver::CHostResolver(CCacheManager *cache) :
+m_cache(cache),
+m_cacheFile(),
+m_resolved(),
+m_jobs(),
+m_threads(),
+m_killed(false),
+m_running(0U),
+m_count(0U),
+m_tries(0U)
+{
+}
+
+CHostResolver::~CHostResolver()
+{
+	stop();
+}
+
+void CHostResolver::setCacheFile(const std::string &fileName)
+{
+	m_cacheFile = fileName;
+	loadCacheFile();
+}
+
+void CHostResolver::add(const std::string &name, const std::string &host, DSTAR_PROTOCOL protocol, bool addrLock)
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+
+	// Unlocked, so that the fresh lookup can replace it
+	auto it = m_resolved.find(host);
+	if (m_resolved.end() != it)
+		m_cache->updateGateway(name, it->second, protocol, false, true);
+
+	SHostJob job = { name, host, protocol, addrLock };
+	m_jobs.push_back(job);
+	m_tries++;
+}
+
+void CHostResolver::start()
+{
+	unsigned int threads = m_jobs.size() < RESOLVER_THREADS ? (unsigned int)m_jobs.size() : RESOLVER_THREADS;
+	if (0U == threads)
+		return;
+
+	m_killed  = false;
+	m_running = threads;
+	for (unsigned int i = 0U; i < threads; i++)
+		m_threads.push_back(std::async(std::launch::async, &CHostResolver::Entry, this));
+}
+
+// Waits for the lookups already in progress, the rest are dropped
+void CHostResolver::stop()
+{
+	m_killed = true;
+
+	for (auto it = m_threads.begin(); it != m_threads.end(); ++it) {
+		if (it->valid())
+			it->get();
+	}
+	m_threads.clear();
+
+	std::lock_guard<std::mutex> lock(m_mutex);
+	m_jobs.clear();
+}
+
+bool CHostResolver::isBusy() const
+{
+	return m_running > 0U;
+}
+
+void CHostResolver::Entry()
+{
+	while (!m_killed) {
+		SHostJob job;
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+			if (m_jobs.empty())
+				break;
+			job = m_jobs.front();
+			m_jobs.pop_front();
+		}
+
+		struct addrinfo hints;
+		::memset(&hints, 0x00U, sizeof(struct addrinfo));
+		hints.ai_family   = AF_INET;
+		hints.ai_socktype = SOCK_DGRAM;
+
+		struct addrinfo *res = NULL;
+		if (0 != ::getaddrinfo(job.m_host.c_str(), NULL, &hints, &res) || NULL == res)
+			continue;
+
+		char address[INET_ADDRSTRLEN];
+		::inet_ntop(AF_INET, &((struct sockaddr_in *)res->ai_addr)->sin_addr, address, INET_ADDRSTRLEN);
+		::freeaddrinfo(res);
+
+		m_cache->updateGateway(job.m_name, address, job.m_protocol, job.m_addrLock, true);
+
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_resolved[job.m_host] = address;
+		m_count++;
+	}
+
+	// The last one out reports and saves the addresses for the next start
+	if (1U == m_running--) {
+		std::lock_guard<std::mutex> lock(m_mutex);
+		printf("Resolved %u of %u reflectors%s\n", m_count, m_tries, m_killed ? ", stopped early" : "");
+		if (!m_killed)
+			saveCacheFile();
+	}
+}
+
+void CHostResolver::loadCacheFile()
+{
+	std::ifstream file(m_cacheFile, std::ifstream::in);
+	if (!file.good())
+		return;
+
+	std::lock_guard<std::mutex> lock(m_mutex);
+	std::string host, address;
+	while (file >> host >> address)
+		m_resolved[host] = address;
+
+	printf("Loaded %u resolved addresses from %s\n", (unsigned int)m_resolved.size(), m_cacheFile.c_str());
+}
+
+// Called with m_mutex held
+void CHostResolver::saveCacheFile()
+{
+	if (m_cacheFile.empty())
+		return;
+
+	std::string tmpName(m_cacheFile + ".tmp");
+	std::ofstream file(tmpName, std::ofstream::out | std::ofstream::trunc);
+	for (auto it = m_resolved.begin(); it != m_resolved.end(); ++it)
+		file << it->first << ' ' << it->second << '\n';
+	file.close();
+
+	if (file.fail() || ::rename(tmpName.c_str(), m_cacheFile.c_str()) < 0)
+		printf("Cannot save the resolved addresses to %s\n", m_cacheFile.c_str());
+}
@@ -0,0 +1,75 @@
+/*
+ *   Copyright (c) 2018 by Thomas A. Early N7TAE
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation; either version 2 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+
+
+#pragma once
+
+#include <atomic>
+#include <deque>
+#include <future>
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "CacheManager.h"
+#include "DStarDefines.h"
+#include "Defs.h"
+
+// Resolves the reflectors in the host files on a small pool of threads, so
+// the server can start routing straight away. Each address goes into the
+// cache as soon as it is known. When a cache file is set, the addresses from
+// the last run are put in the cache first and then refreshed.
+class CHostResolver {
+public:
+	CHostResolver(CCacheManager *cache);
+	~CHostResolver();
+
+	void setCacheFile(const std::string &fileName);
+
+	// Queue a reflector, addrLock is true if ircDDB may not change its address
+	void add(const std::string &name, const std::string &host, DSTAR_PROTOCOL protocol, bool addrLock);
+
+	void start();
+	void stop();
+
+	bool isBusy() const;
+
+private:
+	struct SHostJob {
+		std::string    m_name;
+		std::string    m_host;
+		DSTAR_PROTOCOL m_protocol;
+		bool           m_addrLock;
+	};
+
+	CCacheManager *m_cache;
+	std::string    m_cacheFile;
+	std::map<std::string, std::string> m_resolved;	// host name to dotted address
+	std::deque<SHostJob> m_jobs;
+	std::mutex     m_mutex;
+	std::vector<std::future<void>> m_threads;
+	std::atomic<bool>         m_killed;
+	std::atomic<unsigned int> m_running;
+	unsigned int   m_count;
+	unsigned int   m_tries;
+
+	void Entry();
+	void loadCacheFile();
+	void saveCacheFile();
+};
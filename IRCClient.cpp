@@ -25,6 +25,7 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include <fcntl.h>
 #include <errno.h>
 #include <unistd.h>
+#include <poll.h>
 #include <cstring>
 #include <chrono>
 #include <thread>
@@ -32,6 +33,10 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include "IRCClient.h"
 #include "Utils.h"
 
+#define IRC_RECV_QUEUE_SIZE 4096
+#define IRC_SEND_BATCH 32
+#define IRC_TICK_MS 500
+
 IRCClient::IRCClient(IRCApplication *app, const std::string& update_channel, const std::string& hostName, unsigned int port, const std::string& callsign,
 										const std::string& password, const std::string& versionInfo, const std::string& localAddr)
 {
@@ -91,9 +96,20 @@ void IRCClient::Entry()
 		memset(&myaddr, 0, sizeof(struct sockaddr_in));
 	}
 
+	std::chrono::steady_clock::time_point nextTick = std::chrono::steady_clock::now();
+
 	while (true) {
-		if (timer > 0)
-			timer--;
+		// The timers count 500 ms ticks, however often the queues wake us up
+		std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+		if (now >= nextTick) {
+			nextTick = now + std::chrono::milliseconds(IRC_TICK_MS);
+
+			if (timer > 0)
+				timer--;
+
+			if (5 == state)
+				m_proto->clock();
+		}
 
 		switch (state) {
 			case 0:
@@ -246,7 +262,7 @@ void IRCClient::Entry()
 
 			case 4:
 				{
-					m_recvQ = new IRCMessageQueue();
+					m_recvQ = new IRCMessageQueue(IRC_RECV_QUEUE_SIZE);
 					m_sendQ = new IRCMessageQueue();
 
 					m_recv = new IRCReceiver(sock, m_recvQ);
@@ -263,6 +279,9 @@ void IRCClient::Entry()
 				if (m_terminateThread)
 					state = 6;
 				else {
+					m_recvQ->clearNotify();
+					m_sendQ->clearNotify();
+
 					if (m_recvQ->isEOF()) {
 						timer = 0;
 						state = 6;
@@ -270,29 +289,40 @@ void IRCClient::Entry()
 						timer = 0;
 						state = 6;
 					}
-					while (5==state && m_sendQ->messageAvailable()) {
-						IRCMessage *m = m_sendQ->getMessage();
-						std::string out;
-
-						m->composeMessage(out);
+					// Take the waiting messages in batches and write each batch with one send
+					IRCMessage *batch[IRC_SEND_BATCH];
+					unsigned int count;
+					while (5==state && (count = m_sendQ->getMessages(batch, IRC_SEND_BATCH)) > 0U) {
+						std::string out, all;
+						for (unsigned int i=0; i<count; i++) {
+							batch[i]->composeMessage(out);
+							delete batch[i];
+
+							if (5 != state)
+								continue;
+
+							char buf[200];
+							CUtils::safeStringCopy(buf, out.c_str(), sizeof buf);
+							int len = strlen(buf);
+							if (buf[len - 1] == 10) // is there a NL char at the end?
+								all.append(buf, len);
+							else {
+								printf("IRCClient::Entry: no NL at end, len=%d\n", len);
+								timer = 0;
+								state = 6;
+							}
+						}
 
-						char buf[200];
-						CUtils::safeStringCopy(buf, out.c_str(), sizeof buf);
-						int len = strlen(buf);
-						if (buf[len - 1] == 10) { // is there a NL char at the end?
-							int r = send(sock, buf, len, 0);
+						if (5==state && all.size()) {
+							int len = int(all.size());
+							int r = send(sock, all.data(), len, 0);
 
 							if (r != len) {
 								printf("IRCClient::Entry: short write %d < %d\n", r, len);
 								timer = 0;
 								state = 6;
 							}
-						} else {
-							printf("IRCClient::Entry: no NL at end, len=%d\n", len);
-							timer = 0;
-							state = 6;
 						}
-						delete m;
 					}
 				}
 				break;
@@ -309,6 +339,9 @@ void IRCClient::Entry()
 
 					std::this_thread::sleep_for(std::chrono::seconds(2));
 
+					printf("IRCClient::Entry: receive queue overflows=%lu high water=%u, send queue overflows=%lu high water=%u\n",
+						m_recvQ->getOverflows(), m_recvQ->getHighWater(), m_sendQ->getOverflows(), m_sendQ->getHighWater());
+
 					delete m_recv;
 					delete m_recvQ;
 					delete m_sendQ;
@@ -324,7 +357,21 @@ void IRCClient::Entry()
 				}
 				break;
 		}
-		std::this_thread::sleep_for(std::chrono::milliseconds(500));
+		// Sleep until the next tick, unless there is something to receive or send first
+		std::chrono::steady_clock::duration wait = nextTick - std::chrono::steady_clock::now();
+		int ms = int(std::chrono::duration_cast<std::chrono::milliseconds>(wait).count());
+		if (ms < 0)
+			ms = 0;
+
+		if (5 == state) {
+			struct pollfd fds[2];
+			fds[0].fd = m_recvQ->getNotifyFD();
+			fds[0].events = POLLIN;
+			fds[1].fd = m_sendQ->getNotifyFD();
+			fds[1].events = POLLIN;
+			::poll(fds, 2, ms);
+		} else
+			std::this_thread::sleep_for(std::chrono::milliseconds(ms));
 	}
 	return;
 }
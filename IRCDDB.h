@@ -26,6 +26,8 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include <string>
 #include <vector>
 
+class CSnapshotWriter;
+
 enum IRCDDB_RESPONSE_TYPE {
 	IDRT_NONE,
 	IDRT_USER,
@@ -33,6 +35,17 @@ enum IRCDDB_RESPONSE_TYPE {
 	IDRT_REPEATER
 };
 
+// One waiting reply, as taken by receiveReplies(). Only the fields of its type are set.
+class CIRCDDBReply {
+public:
+	IRCDDB_RESPONSE_TYPE m_type;
+	std::string m_user;
+	std::string m_repeater;
+	std::string m_gateway;
+	std::string m_address;
+	std::string m_timeStamp;
+};
+
 
 class CIRCDDB
 {
@@ -113,12 +126,20 @@ public:
 
 	// Support for the Smart Group Server
 	virtual void sendSGSInfo(const std::string subcommand, const std::vector<std::string> parms) = 0;
+	// The same, already formatted as "SUBCOMMAND PARAM PARAM..."
+	virtual void sendSGSInfo(const std::string &info) = 0;
 
 	// The following functions are for processing received messages
 
 	// Get the waiting message type
 	virtual IRCDDB_RESPONSE_TYPE getMessageType() = 0;
 
+	// For an event loop: readable when replies are waiting. Call clearReplyFD()
+	// when it is, then read replies until getMessageType() returns IDRT_NONE,
+	// or receiveReplies() returns 0.
+	virtual int getReplyFD() = 0;
+	virtual void clearReplyFD() = 0;
+
 	// Get a gateway message, as a result of IDRT_REPEATER returned from getMessageType()
 	// A false return implies a network error
 	virtual bool receiveRepeater(std::string& repeaterCallsign, std::string& gatewayCallsign, std::string& address) = 0;
@@ -133,5 +154,16 @@ public:
 
 	virtual bool receiveUser(std::string& userCallsign, std::string& repeaterCallsign, std::string& gatewayCallsign, std::string& address, std::string& timeStamp) = 0;
 
+	// Take up to max waiting replies of any type in one go, returns how many.
+	// The vector is grown to max if needed and its strings are reused.
+	virtual unsigned int receiveReplies(std::vector<CIRCDDBReply>& replies, unsigned int max) = 0;
+
+	// Keep a copy of the repeater table across restarts, so only the changes
+	// since the snapshot have to be downloaded. Load it before calling open(),
+	// its repeaters are passed on as replies. saveTable() only copies the
+	// table, the caller writes the snapshot out and deletes it.
+	virtual bool loadTable(const std::string& fileName) = 0;
+	virtual CSnapshotWriter *saveTable() = 0;
+
 	virtual void close() = 0;		// Implictely kills any threads in the IRC code
 };
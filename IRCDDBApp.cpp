@@ -22,14 +22,20 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include <netdb.h>
 #include <map>
 #include <mutex>
-#include <regex>
+#include <condition_variable>
 #include <cstdio>
 #include <chrono>
 #include <thread>
 
 #include "IRCDDBApp.h"
+#include "SnapshotFile.h"
+#include "CharClass.h"
+#include "Callsign.h"
 #include "Utils.h"
 
+// Room for a SENDLIST burst without spilling
+#define IRC_REPLY_QUEUE_SIZE 4096
+
 class IRCDDBAppUserObject
 {
 public:
@@ -80,10 +86,7 @@ class IRCDDBAppPrivate
 {
 public:
 	IRCDDBAppPrivate()
-	: tablePattern("^[0-9]$")
-	, datePattern("^20[0-9][0-9]-((1[0-2])|(0[1-9]))-((3[01])|([12][0-9])|(0[1-9]))$")
-	, timePattern("^((2[0-3])|([01][0-9])):[0-5][0-9]:[0-5][0-9]$")
-	, dbPattern("^[0-9A-Z_]{8}$")
+	: replyQ(IRC_REPLY_QUEUE_SIZE)
 	{
 	}
 
@@ -101,11 +104,6 @@ public:
 	std::string channelTopic;
 	std::string bestServer;
 
-	std::regex tablePattern;
-	std::regex datePattern;
-	std::regex timePattern;
-	std::regex dbPattern;
-
 	bool initReady;
 	bool terminateThread;
 
@@ -124,6 +122,11 @@ public:
 
 	std::map<std::string, std::string> moduleWD;
 	std::mutex moduleWDMutex;
+
+	// Wakes Entry() when the state machine has something to do
+	std::mutex wakeMutex;
+	std::condition_variable wakeCond;
+	bool wakeFlag;
 };
 
 IRCDDBApp::IRCDDBApp(const std::string& u_chan)
@@ -132,6 +135,7 @@ IRCDDBApp::IRCDDBApp(const std::string& u_chan)
 {
 	d->sendQ = NULL;
 	d->initReady = false;
+	d->wakeFlag = false;
 
 	userListReset();
 
@@ -163,12 +167,8 @@ void IRCDDBApp::rptrQTH(const std::string& callsign, double latitude, double lon
 	d1.resize(20, '_');
 	d2.resize(20, '_');
 
-	std::regex nonValid("[^a-zA-Z0-9 +&(),./'-]");
-	std::smatch sm;
-	while (std::regex_search(d1, sm, nonValid))
-		d1.erase(sm.position(0), sm.length());
-	while (std::regex_search(d2, sm, nonValid))
-		d2.erase(sm.position(0), sm.length());
+	CCharClass::remove(d1, CC_QTH);
+	CCharClass::remove(d2, CC_QTH);
 
 	CUtils::ReplaceChar(pos, ',', '.');
 	CUtils::ReplaceChar(d1, ' ', '_');
@@ -183,9 +183,7 @@ void IRCDDBApp::rptrQTH(const std::string& callsign, double latitude, double lon
 
 	std::string url = infoURL;
 
-	std::regex urlNonValid("[^[:graph:]]");
-	while (std::regex_search(url, sm, urlNonValid))
-		url.erase(sm.position(0), sm.length());
+	CCharClass::remove(url, CC_GRAPH);
 
 	if (url.size()) {
 		d->moduleURL[cs] = cs + std::string(" ") + url;
@@ -218,10 +216,7 @@ void IRCDDBApp::kickWatchdog(const std::string& callsign, const std::string& s)
 {
 	std::string text = s;
 
-	std::regex nonValid("[^[:graph:]]");
-	std::smatch sm;
-	while (std::regex_search(text, sm, nonValid))
-		text.erase(sm.position(0), sm.length());
+	CCharClass::remove(text, CC_GRAPH);
 
 	if (text.size()) {
 		std::string cs = callsign;
@@ -266,6 +261,16 @@ IRCMessage *IRCDDBApp::getReplyMessage()
 	return d->replyQ.getMessage();
 }
 
+int IRCDDBApp::getReplyFD()
+{
+	return d->replyQ.getNotifyFD();
+}
+
+void IRCDDBApp::clearReplyFD()
+{
+	d->replyQ.clearNotify();
+}
+
 void IRCDDBApp::startWork()
 {
 	d->terminateThread = false;
@@ -275,7 +280,10 @@ void IRCDDBApp::startWork()
 void IRCDDBApp::stopWork()
 {
     d->terminateThread = true;
+	wakeUp();
 	m_future.get();
+
+	printf("IRCDDBApp: reply queue overflows=%lu high water=%u\n", d->replyQ.getOverflows(), d->replyQ.getHighWater());
 }
 
 unsigned int IRCDDBApp::calculateUsn(const std::string& nick)
@@ -442,6 +450,10 @@ void IRCDDBApp::userChanOp(const std::string& nick, bool op)
 	if (d->user.count(lnick) == 1)
 		d->user[lnick].op = op;
 	d->userMapMutex.unlock();
+
+	// state 2 is waiting for a server to show up
+	if (op && 2 == d->state && 0 == lnick.compare(0, 2, "s-"))
+		wakeUp();
 }
 
 static const int numberOfTables = 2;
@@ -551,16 +563,22 @@ bool IRCDDBApp::findRepeater(const std::string& rptrCall)
 }
 
 void IRCDDBApp::sendSGSInfo(const std::string &subcommand, const std::vector<std::string> &pars)
+{
+	std::string info(subcommand);
+	for (auto it=pars.begin(); it!=pars.end(); it++) {
+		info.push_back(' ');
+		info.append(*it);
+	}
+	sendSGSInfo(info);
+}
+
+void IRCDDBApp::sendSGSInfo(const std::string &info)
 {
 	IRCMessageQueue *q = getSendQ();
 	std::string srv(d->currentServer);
 	if (srv.size() && d->state>=6 && q) {
 		std::string command("SGS ");
-		command.append(subcommand);
-		for (auto it=pars.begin(); it!=pars.end(); it++) {
-			command.push_back(' ');
-			command.append(*it);
-		}
+		command.append(info);
 		IRCMessage *m = new IRCMessage(srv, command);
 		q->putMessage(m);
 	}
@@ -575,21 +593,12 @@ bool IRCDDBApp::sendHeard(const std::string& myCall, const std::string& myCallEx
 	std::string r1(rpt1);
 	std::string r2(rpt2);
 	std::string dest(destination);
-	std::regex nonValid("[^A-Z0-9/_]");
-	std::smatch sm;
-	char underScore = '_';
-	while (std::regex_search(my, sm, nonValid))
-		my[sm.position(0)] = underScore;
-	while (std::regex_search(myext, sm, nonValid))
-		myext[sm.position(0)] = underScore;
-	while (std::regex_search(ur, sm, nonValid))
-		ur[sm.position(0)] = underScore;
-	while (std::regex_search(r1, sm, nonValid))
-		r1[sm.position(0)] = underScore;
-	while (std::regex_search(r2, sm, nonValid))
-		r2[sm.position(0)] = underScore;
-	while (std::regex_search(dest, sm, nonValid))
-		dest[sm.position(0)] = underScore;
+	CCharClass::replace(my, CC_CALLSIGN, '_');
+	CCharClass::replace(myext, CC_CALLSIGN, '_');
+	CCharClass::replace(ur, CC_CALLSIGN, '_');
+	CCharClass::replace(r1, CC_CALLSIGN, '_');
+	CCharClass::replace(r2, CC_CALLSIGN, '_');
+	CCharClass::replace(dest, CC_CALLSIGN, '_');
 
 	bool statsMsg = (tx_stats.size() > 0);
 
@@ -662,7 +671,7 @@ void IRCDDBApp::doNotFound(std::string& msg, std::string& retval)
 	std::string tk = tkz.front();
 	tkz.erase(tkz.begin());
 	
-	if (std::regex_match(tk, d->tablePattern)) {
+	if (CCharClass::isTableID(tk)) {
 		tableID = std::stoi(tk);
 
 		if (tableID<0 || tableID>=numberOfTables) {
@@ -678,7 +687,7 @@ void IRCDDBApp::doNotFound(std::string& msg, std::string& retval)
 	}
 
 	if (0 == tableID) {
-		if (! std::regex_match(tk, d->dbPattern))
+		if (! CCharClass::isDBKey(tk))
 			return; // no valid key
 		retval = tk;
 	}
@@ -694,7 +703,7 @@ void IRCDDBApp::doUpdate(std::string& msg)
 	std::string tk = tkz.front();
 	tkz.erase(tkz.begin());
 
-	if (std::regex_match(tk, d->tablePattern)) {
+	if (CCharClass::isTableID(tk)) {
 		tableID = std::stoi(tk);
 		if ((tableID < 0) || (tableID >= numberOfTables)) {
 			printf("invalid table ID %d\n", tableID);
@@ -708,13 +717,13 @@ void IRCDDBApp::doUpdate(std::string& msg)
 		tkz.erase(tkz.begin());
 	}
 
-	if (std::regex_match(tk, d->datePattern)) {
+	if (CCharClass::isDate(tk)) {
 		if (tkz.empty())
 			return;  // nothing after date string
 
 		std::string timeToken = tkz.front();	// time token
 		tkz.erase(tkz.begin());
-		if (! std::regex_match(timeToken, d->timePattern))
+		if (! CCharClass::isTime(timeToken))
 			return; // no time string after date string
 
 		time_t dt = CUtils::parseTime(tk + std::string(" ") + timeToken);
@@ -726,7 +735,7 @@ void IRCDDBApp::doUpdate(std::string& msg)
 			std::string key = tkz.front();
 			tkz.erase(tkz.begin());
 
-			if (! std::regex_match(key, d->dbPattern))
+			if (! CCharClass::isDBKey(key))
 				return; // no valid key
 
 			if (tkz.empty())
@@ -735,7 +744,7 @@ void IRCDDBApp::doUpdate(std::string& msg)
 			std::string value = tkz.front();
 			tkz.erase(tkz.begin());
 
-			if (! std::regex_match(value, d->dbPattern))
+			if (! CCharClass::isDBKey(value))
 				return; // no valid key
 
 			if (tableID == 1) {
@@ -743,20 +752,8 @@ void IRCDDBApp::doUpdate(std::string& msg)
 				IRCDDBAppRptrObject newRptr(dt, key, value, m_maxTime);
 				d->rptrMap[key] = newRptr;
 
-				if (d->initReady) {
-					std::string arearp_cs(key);
-					std::string zonerp_cs(value);
-					CUtils::ReplaceChar(arearp_cs, '_', ' ');
-					CUtils::ReplaceChar(zonerp_cs, '_', ' ');
-					zonerp_cs.resize(7, ' ');
-					zonerp_cs.push_back('G');
-
-					IRCMessage *m2 = new IRCMessage("IDRT_REPEATER");
-					m2->addParam(arearp_cs);
-					m2->addParam(zonerp_cs);
-					m2->addParam(getIPAddress(value));
-					d->replyQ.putMessage(m2);
-				}
+				if (d->initReady)
+					putRepeater(key, value, getIPAddress(value));
 				d->rptrMapMutex.unlock();
 			} else if (0==tableID && d->initReady) {
 				d->rptrMapMutex.lock();
@@ -825,11 +822,15 @@ void IRCDDBApp::msgQuery(IRCMessage *m)
 			}
 			doUpdate(restOfLine);
 		} else if (0 == cmd.compare("LIST_END")) {
-			if (5 == d->state) // if in sendlist processing state
+			if (5 == d->state) { // if in sendlist processing state
 				d->state = 3;  // get next table
+				wakeUp();
+			}
 		} else if (0 == cmd.compare("LIST_MORE")) {
-			if (5 == d->state) // if in sendlist processing state
+			if (5 == d->state) { // if in sendlist processing state
 				d->state = 4;  // send next SENDLIST
+				wakeUp();
+			}
 		} else if (0 == cmd.compare("NOT_FOUND")) {
 			std::string callsign;
 			std::string restOfLine;
@@ -856,6 +857,14 @@ void IRCDDBApp::msgQuery(IRCMessage *m)
 void IRCDDBApp::setSendQ(IRCMessageQueue *s)
 {
 	d->sendQ = s;
+	wakeUp();
+}
+
+void IRCDDBApp::wakeUp()
+{
+	std::lock_guard<std::mutex> lock(d->wakeMutex);
+	d->wakeFlag = true;
+	d->wakeCond.notify_one();
 }
 
 IRCMessageQueue *IRCDDBApp::getSendQ()
@@ -863,6 +872,23 @@ IRCMessageQueue *IRCDDBApp::getSendQ()
 	return d->sendQ;
 }
 
+// An entry of the repeater table as a reply, the keys have '_' for spaces
+void IRCDDBApp::putRepeater(const std::string& key, const std::string& value, const std::string& address)
+{
+	std::string arearp_cs(key);
+	std::string zonerp_cs(value);
+	CUtils::ReplaceChar(arearp_cs, '_', ' ');
+	CUtils::ReplaceChar(zonerp_cs, '_', ' ');
+	zonerp_cs.resize(7, ' ');
+	zonerp_cs.push_back('G');
+
+	IRCMessage *m2 = new IRCMessage("IDRT_REPEATER");
+	m2->addParam(arearp_cs);
+	m2->addParam(zonerp_cs);
+	m2->addParam(address);
+	d->replyQ.putMessage(m2);
+}
+
 std::string IRCDDBApp::getLastEntryTime(int tableID)
 {
 	if (1 == tableID) {
@@ -875,6 +901,57 @@ std::string IRCDDBApp::getLastEntryTime(int tableID)
 	return "DBERROR";
 }
 
+const char TABLE_SNAPSHOT_MAGIC[] = "SGST";
+const uint32_t TABLE_SNAPSHOT_VERSION = 1U;
+
+struct SRptrSnapshot {
+	uint64_t arearp_cs;
+	uint64_t zonerp_cs;
+	int64_t  lastChanged;
+};
+
+CSnapshotWriter *IRCDDBApp::saveTable()
+{
+	CSnapshotWriter *snapshot = new CSnapshotWriter(TABLE_SNAPSHOT_MAGIC, TABLE_SNAPSHOT_VERSION);
+
+	d->rptrMapMutex.lock();
+	for (auto it = d->rptrMap.begin(); it != d->rptrMap.end(); ++it) {
+		SRptrSnapshot s = { CCallsign(it->second.arearp_cs).getValue(), CCallsign(it->second.zonerp_cs).getValue(), int64_t(it->second.lastChanged) };
+		snapshot->add(0U, &s, sizeof(SRptrSnapshot));
+	}
+	d->rptrMapMutex.unlock();
+
+	return snapshot;
+}
+
+// The SENDLIST for the repeater table then starts from the newest entry in the
+// snapshot. The table can be ahead of the cache snapshot, so every repeater in
+// it is also queued as a reply. Their gateway addresses come later, from ircDDB.
+bool IRCDDBApp::loadTable(const std::string& fileName)
+{
+	CSnapshotReader snapshot;
+	if (!snapshot.open(fileName, TABLE_SNAPSHOT_MAGIC, TABLE_SNAPSHOT_VERSION))
+		return false;
+
+	unsigned int count;
+	const SRptrSnapshot *s = snapshot.getSection<SRptrSnapshot>(0U, count);
+
+	d->rptrMapMutex.lock();
+	for (unsigned int i = 0U; i < count; i++) {
+		std::string key(CCallsign::fromValue(s[i].arearp_cs).getString());
+		std::string value(CCallsign::fromValue(s[i].zonerp_cs).getString());
+		time_t dt = time_t(s[i].lastChanged);
+
+		IRCDDBAppRptrObject newRptr(dt, key, value, m_maxTime);
+		d->rptrMap[key] = newRptr;
+		putRepeater(key, value, "");
+	}
+	d->rptrMapMutex.unlock();
+
+	printf("Loaded %u repeaters from %s, last entry time %s\n", count, fileName.c_str(), getLastEntryTime(1).c_str());
+	return true;
+}
+
 static bool needsDatabaseUpdate(int tableID)
 {
 	return (1 == tableID);
@@ -883,9 +960,20 @@ static bool needsDatabaseUpdate(int tableID)
 void IRCDDBApp::Entry()
 {
 	int sendlistTableID = 0;
+	std::chrono::steady_clock::time_point nextTick = std::chrono::steady_clock::now();
+
 	while (!d->terminateThread) {
-		if (d->timer > 0)
-			d->timer--;
+		// The timers count seconds, however often we are woken up
+		bool tick = false;
+		std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+		if (now >= nextTick) {
+			nextTick = now + std::chrono::seconds(1);
+			tick = true;
+			if (d->timer > 0)
+				d->timer--;
+		}
+
+		int state = d->state;
 		switch(d->state) {
 			case 0:	// wait for network to start
 				if (getSendQ())
@@ -974,7 +1062,7 @@ void IRCDDBApp::Entry()
 				if (NULL == getSendQ())
 					d->state = 10; // disconnect DB
 
-				if (d->infoTimer > 0) {
+				if (tick && d->infoTimer > 0) {
 					d->infoTimer--;
 
 					if (0 == d->infoTimer) {
@@ -1011,7 +1099,7 @@ void IRCDDBApp::Entry()
 					}
 				}
 
-				if (d->wdTimer > 0) {
+				if (tick && d->wdTimer > 0) {
 					d->wdTimer--;
 
 					if (0 == d->wdTimer) {
@@ -1037,7 +1125,12 @@ void IRCDDBApp::Entry()
 				d->initReady = false;
 				break;
 		}
-		std::this_thread::sleep_for(std::chrono::seconds(1));
+		// Straight on while the state is changing, otherwise wait for the next second or a wake up
+		if (state == d->state) {
+			std::unique_lock<std::mutex> lock(d->wakeMutex);
+			d->wakeCond.wait_until(lock, nextTick, [this] { return d->wakeFlag; });
+			d->wakeFlag = false;
+		}
 	} // while
 	return;
 }
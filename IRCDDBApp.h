@@ -63,6 +63,9 @@ public:
 
 	IRCMessage *getReplyMessage();
 
+	int getReplyFD();
+	void clearReplyFD();
+
 	bool findUser(const std::string& s);
 	bool findRepeater(const std::string& s);
 	bool findGateway(const std::string& s);
@@ -71,6 +74,7 @@ public:
 		unsigned char flag2, unsigned char flag3, const std::string& destination, const std::string& tx_msg, const std::string& tx_stats);
 
 	void sendSGSInfo(const std::string &subcommand, const std::vector<std::string> &pars);
+	void sendSGSInfo(const std::string &info);
 
 	int getConnectionState();
 
@@ -80,6 +84,9 @@ public:
 
 	void kickWatchdog(const std::string& callsign, const std::string& wdInfo);
 
+	bool loadTable(const std::string& fileName);
+	CSnapshotWriter *saveTable();
+
 protected:
 	void Entry();
 
@@ -87,9 +94,11 @@ private:
 	void doUpdate(std::string& msg);
 	void doNotFound(std::string& msg, std::string& retval);
 	std::string getIPAddress(std::string& zonerp_cs);
+	void putRepeater(const std::string& key, const std::string& value, const std::string& address);
 	bool findServerUser();
 	unsigned int calculateUsn(const std::string& nick);
 	std::string getLastEntryTime(int tableID);
+	void wakeUp();
 	IRCDDBAppPrivate *d;
 	time_t m_maxTime;
 	std::future<void> m_future;
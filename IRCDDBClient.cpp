@@ -117,6 +117,11 @@ void CIRCDDBClient::sendSGSInfo(const std::string subcommand, const std::vector<
 	d->app->sendSGSInfo(subcommand, parms);
 }
 
+void CIRCDDBClient::sendSGSInfo(const std::string &info)
+{
+	d->app->sendSGSInfo(info);
+}
+
 // Send heard data, a false return implies a network error
 bool CIRCDDBClient::sendHeardWithTXMsg(const std::string& myCall, const std::string& myCallExt, const std::string& yourCall, const std::string& rpt1,
 	const std::string& rpt2, unsigned char flag1, unsigned char flag2, unsigned char flag3, const std::string& network_destination, const std::string& tx_message)
@@ -275,6 +280,16 @@ IRCDDB_RESPONSE_TYPE CIRCDDBClient::getMessageType()
 	return d->app->getReplyMessageType();
 }
 
+int CIRCDDBClient::getReplyFD()
+{
+	return d->app->getReplyFD();
+}
+
+void CIRCDDBClient::clearReplyFD()
+{
+	d->app->clearReplyFD();
+}
+
 // Get a gateway message, as a result of IDRT_REPEATER returned from getMessageType()
 // A false return implies a network error
 bool CIRCDDBClient::receiveRepeater(std::string& repeaterCallsign, std::string& gatewayCallsign, std::string& address)
@@ -392,6 +407,57 @@ bool CIRCDDBClient::receiveUser(std::string& userCallsign, std::string& repeater
 	return true;
 }
 
+unsigned int CIRCDDBClient::receiveReplies(std::vector<CIRCDDBReply>& replies, unsigned int max)
+{
+	if (replies.size() < max)
+		replies.resize(max);
+
+	unsigned int count = 0U;
+	while (count < max) {
+		IRCMessage *m = d->app->getReplyMessage();
+		if (m == NULL)
+			break;
+
+		CIRCDDBReply &reply = replies[count];
+		const std::string &cmd = m->command;
+		if (0 == cmd.compare("IDRT_USER") && 5 == m->numParams) {
+			reply.m_type = IDRT_USER;
+			reply.m_user.assign(m->params[0]);
+			reply.m_repeater.assign(m->params[1]);
+			reply.m_gateway.assign(m->params[2]);
+			reply.m_address.assign(m->params[3]);
+			reply.m_timeStamp.assign(m->params[4]);
+			count++;
+		} else if (0 == cmd.compare("IDRT_REPEATER") && 3 == m->numParams) {
+			reply.m_type = IDRT_REPEATER;
+			reply.m_repeater.assign(m->params[0]);
+			reply.m_gateway.assign(m->params[1]);
+			reply.m_address.assign(m->params[2]);
+			count++;
+		} else if (0 == cmd.compare("IDRT_GATEWAY") && 2 == m->numParams) {
+			reply.m_type = IDRT_GATEWAY;
+			reply.m_gateway.assign(m->params[0]);
+			reply.m_address.assign(m->params[1]);
+			count++;
+		} else
+			printf("CIRCDDBClient::receiveReplies: unexpected message '%s' with %d parameters\n", cmd.c_str(), m->numParams);
+
+		delete m;
+	}
+
+	return count;
+}
+
+bool CIRCDDBClient::loadTable(const std::string& fileName)
+{
+	return d->app->loadTable(fileName);
+}
+
+CSnapshotWriter *CIRCDDBClient::saveTable()
+{
+	return d->app->saveTable();
+}
+
 void CIRCDDBClient::close()		// Implictely kills any threads in the IRC code
 {
 	d->client -> stopWork();
@@ -108,12 +108,19 @@ public:
 
 	// Support for the Smart Group Server
 	void sendSGSInfo(const std::string subcommand, const std::vector<std::string> parms);
+	void sendSGSInfo(const std::string &info);
 
 	// The following functions are for processing received messages
 	
 	// Get the waiting message type
 	IRCDDB_RESPONSE_TYPE getMessageType();
 
+	// For an event loop: readable when replies are waiting. Call clearReplyFD()
+	// when it is, then read replies until getMessageType() returns IDRT_NONE,
+	// or receiveReplies() returns 0.
+	int getReplyFD();
+	void clearReplyFD();
+
 	// Get a gateway message, as a result of IDRT_REPEATER returned from getMessageType()
 	// A false return implies a network error
 	bool receiveRepeater(std::string& repeaterCallsign, std::string& gatewayCallsign, std::string& address);
@@ -128,6 +135,17 @@ public:
 
 	bool receiveUser(std::string& userCallsign, std::string& repeaterCallsign, std::string& gatewayCallsign, std::string& address, std::string& timeStamp);
 
+	// Take up to max waiting replies of any type in one go, returns how many.
+	// The vector is grown to max if needed and its strings are reused.
+	unsigned int receiveReplies(std::vector<CIRCDDBReply>& replies, unsigned int max);
+
+	// Keep a copy of the repeater table across restarts, so only the changes
+	// since the snapshot have to be downloaded. Load it before calling open(),
+	// its repeaters are passed on as replies. saveTable() only copies the
+	// table, the caller writes the snapshot out and deletes it.
+	bool loadTable(const std::string& fileName);
+	CSnapshotWriter *saveTable();
+
 	void close();		// Implictely kills any threads in the IRC code
 
 private:
@@ -48,6 +48,16 @@ IRCMessage::~IRCMessage()
 }
 
 
+void IRCMessage::clear()
+{
+	prefix.clear();
+	command.clear();
+	params.clear();
+	numParams = 0;
+	prefixComponents.clear();
+	prefixParsed = false;
+}
+
 void IRCMessage::addParam(const std::string& p)
 {
 	params.push_back(p);
@@ -42,6 +42,9 @@ public:
 	void composeMessage(std::string& output);
 	void addParam(const std::string& p);
 
+	// Empty it for reuse, the strings keep their memory
+	void clear();
+
 	std::string getCommand();
 	std::string getParam(int pos);
 	int getParamCount();
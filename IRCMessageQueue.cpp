@@ -21,21 +21,48 @@ You should have received a copy of the GNU General Public License
 along with this program.  If not, see <http://www.gnu.org/licenses/>.
 */
 
+#include <cstdint>
+#include <cstdio>
+#include <unistd.h>
+#include <sys/eventfd.h>
+
 #include "IRCMessageQueue.h"
 
-IRCMessageQueue::IRCMessageQueue()
+IRCMessageQueue::IRCMessageQueue(unsigned int size) :
+m_eof(false),
+m_notifyFD(-1),
+m_notified(false),
+m_otherCount(0U),
+m_front(NULL),
+m_next(0U),
+m_free(size),
+m_overflows(0UL),
+m_highWater(0U)
 {
-	m_eof = false;
+	for (int i=0; i<IRC_QUEUE_PRODUCERS; i++) {
+		m_producer[i].m_thread = std::thread::id();
+		m_producer[i].m_ring = new CSPSCRing<IRCMessage *>(size);
+		m_producer[i].m_spilling = false;
+	}
+
+	m_notifyFD = ::eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+	if (m_notifyFD < 0)
+		printf("IRCMessageQueue: cannot create the eventfd\n");
 }
 
 IRCMessageQueue::~IRCMessageQueue()
 {
-	accessMutex.lock();
-	while (! m_queue.empty()) {
-		delete m_queue.front();
-		m_queue.pop();
-	}
-	accessMutex.unlock();
+	IRCMessage *m;
+	while (NULL != (m = getMessage()))
+		delete m;
+	while (m_free.pop(m))
+		delete m;
+
+	for (int i=0; i<IRC_QUEUE_PRODUCERS; i++)
+		delete m_producer[i].m_ring;
+
+	if (m_notifyFD >= 0)
+		::close(m_notifyFD);
 }
 
 bool IRCMessageQueue::isEOF()
@@ -46,41 +73,186 @@ bool IRCMessageQueue::isEOF()
 void IRCMessageQueue::signalEOF()
 {
 	m_eof = true;
+	notify();
 }
 
-bool IRCMessageQueue::messageAvailable()
+int IRCMessageQueue::getNotifyFD() const
 {
-  accessMutex.lock();
-  bool retv = ! m_queue.empty();
-  accessMutex.unlock();
-  return retv;
+	return m_notifyFD;
 }
 
-IRCMessage *IRCMessageQueue::peekFirst()
+// Only the first message since the consumer last woke up costs a write()
+void IRCMessageQueue::notify()
+{
+	if (m_notifyFD >= 0 && ! m_notified.exchange(true)) {
+		uint64_t one = 1U;
+		if (::write(m_notifyFD, &one, sizeof(uint64_t)) < 0)
+			printf("IRCMessageQueue: cannot write the eventfd\n");
+	}
+}
+
+void IRCMessageQueue::clearNotify()
+{
+	if (m_notifyFD < 0)
+		return;
+
+	// Clear the flag first, so a put from now on will write again
+	m_notified = false;
+	uint64_t count;
+	ssize_t n = ::read(m_notifyFD, &count, sizeof(uint64_t));	// EAGAIN if nothing was written
+	(void)n;
+}
+
+// The ring owned by the calling thread, NULL if they're all taken
+IRCMessageQueue::SProducer *IRCMessageQueue::getProducer()
 {
+	std::thread::id self = std::this_thread::get_id();
+
+	for (int i=0; i<IRC_QUEUE_PRODUCERS; i++) {
+		std::thread::id owner = m_producer[i].m_thread.load(std::memory_order_acquire);
+		if (owner == self)
+			return &m_producer[i];
+		if (owner == std::thread::id()) {
+			if (m_producer[i].m_thread.compare_exchange_strong(owner, self, std::memory_order_acq_rel))
+				return &m_producer[i];
+			if (owner == self)
+				return &m_producer[i];
+		}
+	}
+
+	return NULL;
+}
+
+void IRCMessageQueue::putMessage(IRCMessage *m)
+{
+	SProducer *p = getProducer();
+
+	if (NULL == p) {
+		accessMutex.lock();
+		m_other.push_back(m);
+		m_otherCount++;
+		accessMutex.unlock();
+		notify();
+		return;
+	}
+
+	if (! p->m_spilling.load(std::memory_order_acquire)) {
+		if (p->m_ring->push(m)) {
+			unsigned int count = p->m_ring->getCount();
+			if (count > m_highWater.load(std::memory_order_relaxed))
+				m_highWater.store(count, std::memory_order_relaxed);
+			notify();
+			return;
+		}
+		m_overflows++;
+	}
+
 	accessMutex.lock();
-	IRCMessage *msg = m_queue.empty() ? NULL : m_queue.front();
+	if (p->m_spilling || ! p->m_ring->push(m)) {
+		// Everything after the full ring goes in the spill list, to stay in order
+		p->m_spill.push_back(m);
+		p->m_spilling = true;
+	}
 	accessMutex.unlock();
-	return msg;
+	notify();
+}
+
+IRCMessage *IRCMessageQueue::pop()
+{
+	IRCMessage *m = NULL;
+
+	for (int n=0; n<IRC_QUEUE_PRODUCERS; n++) {
+		SProducer &p = m_producer[(m_next + n) % IRC_QUEUE_PRODUCERS];
+
+		if (p.m_ring->pop(m))
+			return m;
+
+		// The ring is empty, so anything older than the spill list has gone
+		if (p.m_spilling.load(std::memory_order_acquire)) {
+			accessMutex.lock();
+			if (! p.m_spill.empty()) {
+				m = p.m_spill.front();
+				p.m_spill.pop_front();
+			}
+			if (p.m_spill.empty())
+				p.m_spilling = false;
+			accessMutex.unlock();
+			if (m)
+				return m;
+		}
+	}
+
+	if (m_otherCount.load(std::memory_order_acquire) > 0U) {
+		accessMutex.lock();
+		if (! m_other.empty()) {
+			m = m_other.front();
+			m_other.pop_front();
+			m_otherCount--;
+		}
+		accessMutex.unlock();
+	}
+
+	m_next = (m_next + 1U) % IRC_QUEUE_PRODUCERS;
+
+	return m;
+}
+
+bool IRCMessageQueue::messageAvailable()
+{
+	return NULL != peekFirst();
+}
+
+IRCMessage *IRCMessageQueue::peekFirst()
+{
+	if (NULL == m_front)
+		m_front = pop();
+	return m_front;
 }
 
 IRCMessage *IRCMessageQueue::getMessage()
 {
-	accessMutex.lock();
-	IRCMessage *msg = m_queue.empty() ? NULL : m_queue.front();
-	if (msg)
-		m_queue.pop();
-	accessMutex.unlock();
+	IRCMessage *msg = peekFirst();
+	m_front = NULL;
 	return msg;
 }
 
-void IRCMessageQueue::putMessage(IRCMessage *m)
+unsigned int IRCMessageQueue::getMessages(IRCMessage **msgs, unsigned int max)
 {
-	accessMutex.lock();
-	m_queue.push(m);
-	accessMutex.unlock();
+	unsigned int count = 0U;
+
+	while (count < max) {
+		IRCMessage *m = getMessage();
+		if (NULL == m)
+			break;
+		msgs[count++] = m;
+	}
+
+	return count;
 }
 
+IRCMessage *IRCMessageQueue::newMessage()
+{
+	IRCMessage *m;
+	if (m_free.pop(m)) {
+		m->clear();
+		return m;
+	}
 
+	return new IRCMessage();
+}
+
+void IRCMessageQueue::releaseMessage(IRCMessage *m)
+{
+	if (! m_free.push(m))
+		delete m;
+}
 
+unsigned long IRCMessageQueue::getOverflows() const
+{
+	return m_overflows;
+}
 
+unsigned int IRCMessageQueue::getHighWater() const
+{
+	return m_highWater;
+}
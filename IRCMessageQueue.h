@@ -23,27 +23,76 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 
 #pragma once
 
+#include <atomic>
+#include <deque>
 #include <mutex>
-#include <queue>
+#include <thread>
 
 #include "IRCMessage.h"
+#include "SPSCRing.h"
 
+#define IRC_QUEUE_PRODUCERS 4
+#define IRC_QUEUE_SIZE 1024
+
+// A queue with one consumer thread and a few producer threads. Each producer
+// thread claims its own lock-free ring the first time it puts a message, so
+// the producers never contend with the consumer or with each other. When a
+// ring is full its producer spills into a locked list until the consumer has
+// caught up, which keeps the order of every producer's messages.
 class IRCMessageQueue
 {
 public:
-	IRCMessageQueue();
+	IRCMessageQueue(unsigned int size = IRC_QUEUE_SIZE);
 	~IRCMessageQueue();
 
 	bool isEOF();
 	void signalEOF();
+
+	// Readable once a message has been put, for poll() or epoll. The consumer
+	// calls clearNotify() when it wakes, and then takes every waiting message.
+	int getNotifyFD() const;
+	void clearNotify();
+
+	// Any thread
+	void putMessage(IRCMessage *m);
+
+	// Consumer only
 	bool messageAvailable();
 	IRCMessage *getMessage();
 	IRCMessage *peekFirst();
-	void putMessage(IRCMessage *m);
+	unsigned int getMessages(IRCMessage **msgs, unsigned int max);
+
+	// Message recycling, for a queue with a single producer thread
+	IRCMessage *newMessage();					// producer only
+	void releaseMessage(IRCMessage *m);		// consumer only
+
+	// Backpressure: how often a producer found its ring full, and the most
+	// messages that were ever waiting in one ring
+	unsigned long getOverflows() const;
+	unsigned int getHighWater() const;
 
 private:
-	bool m_eof;
+	struct SProducer {
+		std::atomic<std::thread::id> m_thread;
+		CSPSCRing<IRCMessage *>     *m_ring;
+		std::atomic<bool>            m_spilling;
+		std::deque<IRCMessage *>     m_spill;	// under accessMutex
+	};
+
+	std::atomic<bool> m_eof;
+	int m_notifyFD;
+	std::atomic<bool> m_notified;
 	std::mutex accessMutex;
-	std::queue<IRCMessage *> m_queue;
-};
+	SProducer m_producer[IRC_QUEUE_PRODUCERS];
+	std::deque<IRCMessage *> m_other;			// threads without a ring, under accessMutex
+	std::atomic<unsigned int> m_otherCount;
+	IRCMessage *m_front;						// consumer only, what peekFirst() returned
+	unsigned int m_next;						// consumer only, the ring to try first
+	CSPSCRing<IRCMessage *> m_free;			// used messages, from the consumer back to the producer
+	std::atomic<unsigned long> m_overflows;
+	std::atomic<unsigned int> m_highWater;
 
+	SProducer *getProducer();
+	void notify();
+	IRCMessage *pop();
+};
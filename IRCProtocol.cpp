@@ -18,8 +18,6 @@ You should have received a copy of the GNU General Public License
 along with this program.  If not, see <http://www.gnu.org/licenses/>.
 */
 
-#include <regex>
-
 #include "IRCProtocol.h"
 #include "Utils.h"
 
@@ -82,18 +80,28 @@ void IRCProtocol::setNetworkReady(bool b)
 }
 
 
-bool IRCProtocol::processQueues(IRCMessageQueue *recvQ, IRCMessageQueue *sendQ)
+void IRCProtocol::clock()
 {
 	if (m_timer > 0)
 		m_timer--;
+}
+
+// ^grp[1-9]s[1-9].ircDDB$, where the '.' is any character
+static bool isServerName(const std::string& s)
+{
+	return 13U == s.size() && 0 == s.compare(0, 3, "grp") && s[3] >= '1' && s[3] <= '9' && 's' == s[4] &&
+		s[5] >= '1' && s[5] <= '9' && '\n' != s[6] && '\r' != s[6] && 0 == s.compare(7, 6, "ircDDB");
+}
 
+// Can be called as often as there are messages, the timers run off clock()
+bool IRCProtocol::processQueues(IRCMessageQueue *recvQ, IRCMessageQueue *sendQ)
+{
 	while (recvQ->messageAvailable()) {
 		IRCMessage *m = recvQ->getMessage();
 		if (0 == m->command.compare("004")) {
 			if (4 == m_state) {
 				if (m->params.size() > 1) {
-					std::regex serverNamePattern("^grp[1-9]s[1-9].ircDDB$");
-					if (std::regex_match(m->params[1], serverNamePattern))
+					if (isServerName(m->params[1]))
 						m_app->setBestServer(std::string("s-") + m->params[1].substr(0,6));
 				}
 				m_state = 5;  // next: JOIN
@@ -183,7 +191,7 @@ bool IRCProtocol::processQueues(IRCMessageQueue *recvQ, IRCMessageQueue *sendQ)
 				m_app->setTopic(m->params[1]);
 		}
 
-		delete m;
+		recvQ->releaseMessage(m);
 	}
 
 	IRCMessage *m;
@@ -35,6 +35,7 @@ public:
 
 	void setNetworkReady(bool state);
 	bool processQueues(IRCMessageQueue *recvQ, IRCMessageQueue *sendQ);
+	void clock();	// every 500 ms
 
 private:
 	void chooseNewNick();
@@ -21,9 +21,14 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include <sys/types.h>
 #include <sys/socket.h>
 
+#include <cstring>
+
 #include "IRCReceiver.h"
 #include "Utils.h"
 
+// Big enough for a whole SENDLIST packet at a time
+#define IRC_RECEIVE_BUFFER 16384
+
 IRCReceiver::IRCReceiver(int sock, IRCMessageQueue *q)
 {
 	m_sock = sock;
@@ -85,76 +90,102 @@ static int doRead(int sock, char *buf, int buf_size)
 	return 0;
 }
 
+// The original byte at a time parser dropped these wherever they were
+static bool isNoise(char b)
+{
+	return b <= 0 || b == '\r';
+}
+
+// Split one line, without the '\n', into a message. Each field is copied once.
+static void parseLine(IRCMessage *m, char *line, unsigned int len)
+{
+	// Drop CRs, NULs and 8 bit characters, almost always just the final CR
+	while (len > 0U && '\r' == line[len - 1U])
+		len--;
+	unsigned int n = 0U;
+	while (n < len && !isNoise(line[n]))
+		n++;
+	for (unsigned int i = n; i < len; i++) {
+		if (!isNoise(line[i]))
+			line[n++] = line[i];
+	}
+	len = n;
+
+	const char *p   = line;
+	const char *end = line + len;
+
+	while (p < end && ' ' == *p)
+		p++;
+
+	if (p < end && ':' == *p) {
+		const char *space = (const char *)::memchr(p, ' ', end - p);
+		const char *stop  = space ? space : end;
+		m->prefix.assign(p + 1, stop - p - 1);
+		p = space ? space + 1 : end;
+	}
+
+	const char *space = (const char *)::memchr(p, ' ', end - p);
+	m->command.assign(p, (space ? space : end) - p);
+	if (NULL == space)
+		return;
+	p = space + 1;
+
+	// Every space starts a new parameter, a leading ':' takes the rest of the line
+	while (true) {
+		m->numParams++;
+		if (p < end && ':' == *p) {
+			m->params.push_back(std::string(p + 1, end - p - 1));
+			return;
+		}
+
+		space = (const char *)::memchr(p, ' ', end - p);
+		m->params.push_back(std::string(p, (space ? space : end) - p));
+		if (NULL == space)
+			return;
+		p = space + 1;
+
+		if (m->numParams >= 14) {
+			// the original kept a 15th, empty, parameter and ignored the rest
+			m->numParams++;
+			m->params.push_back(std::string(""));
+			return;
+		}
+	}
+}
+
 void IRCReceiver::Entry()
 {
-	IRCMessage *m = new IRCMessage();
-	int state = 0;
+	char buf[IRC_RECEIVE_BUFFER];
+	unsigned int length = 0U;		// bytes waiting in buf
 
 	while (! m_terminateThread) {
-		char buf[200];
-		int r = doRead(m_sock, buf, sizeof buf);
+		int r = doRead(m_sock, buf + length, IRC_RECEIVE_BUFFER - length);
 
 		if (r < 0) {
 			m_recvQ->signalEOF();
-			delete m;  // delete unfinished IRCMessage
 			break;
 		}
 
-		for (int i=0; i < r; i++) {
-			char b = buf[i];
-			if (b > 0) {
-				if (b == '\n') {
-					m_recvQ->putMessage(m);
-					m = new IRCMessage();
-					state = 0;
-				}
-				else if (b != '\r') {
-					switch (state) {
-						case 0:	// command
-							if (b == ':')
-								state = 1; // prefix
-							else if (b != ' ') {
-								m->command.push_back(b);
-								state = 2; // command
-							}
-							break;
-
-						case 1:	// prefix
-							if (b == ' ')
-								state = 2; // command is next
-							else
-								m->prefix.push_back(b);
-							break;
-
-						case 2:
-							if (b == ' ') {
-								state = 3; // params are next
-								m->numParams = 1;
-								m->params.push_back(std::string(""));
-							} else
-								m->command.push_back(b);
-							break;
-
-						case 3:
-							if (b == ' ') {
-								m->numParams++;
-								if (m->numParams >= 15)
-									state = 5; // ignore the rest
-								m->params.push_back(std::string(""));
-							} else if (b==':' && m->params[m->numParams-1].size()==0)
-								state = 4; // rest of line is this param
-							else
-								m->params[m->numParams-1].push_back(b);
-							break;
-
-						case 4:
-							m->params[m->numParams-1].push_back(b);
-							break;
-					} // switch
-				}
-			} // if
-		} // for
-	} // while
+		length += r;
+
+		// Hand over every complete line
+		char *line = buf;
+		char *end  = buf + length;
+		char *nl;
+		while (NULL != (nl = (char *)::memchr(line, '\n', end - line))) {
+			IRCMessage *m = m_recvQ->newMessage();
+			parseLine(m, line, nl - line);
+			m_recvQ->putMessage(m);
+			line = nl + 1;
+		}
+
+		length = end - line;
+		if (length == IRC_RECEIVE_BUFFER) {
+			// A line longer than the buffer, no IRC server sends those
+			printf("IRCReceiver::Entry: line too long, discarding %u bytes\n", length);
+			length = 0U;
+		} else if (line != buf && length > 0U)
+			::memmove(buf, line, length);
+	}
 	return;
 }
-
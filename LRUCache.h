@@ -0,0 +1,215 @@
+/*
+ *   Copyright (c) 2018 by Thomas A. Early N7TAE
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation; either version 2 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+
+
+#pragma once
+
+#include <atomic>
+#include <ctime>
+#include <iterator>
+#include <list>
+#include <unordered_map>
+
+#include "Callsign.h"
+
+// A cache of at most m_capacity records. When it's full the least recently
+// used record is dropped, and records that haven't been updated for m_ttl
+// seconds are treated as missing. A capacity or ttl of 0 means no limit.
+//
+// find() only marks the record it returns, so any number of threads may call
+// it together, but everything else needs the cache to itself. The marked
+// records get a second chance when the oldest one is about to be dropped
+// (the CLOCK approximation of LRU).
+template <typename R> class CLRUCache {
+public:
+	CLRUCache(unsigned int capacity, unsigned int ttl) :
+	m_capacity(capacity),
+	m_ttl(ttl),
+	m_list(),
+	m_index(),
+	m_hits(0UL),
+	m_misses(0UL),
+	m_evictions(0UL)
+	{
+	}
+
+	void setLimits(unsigned int capacity, unsigned int ttl)
+	{
+		m_capacity = capacity;
+		m_ttl = ttl;
+
+		while (m_capacity && m_index.size() > m_capacity)
+			evict();
+	}
+
+	// Doesn't insert anything on a miss, a stale record is left for evict()
+	const R *find(const CCallsign &key) const
+	{
+		auto it = m_index.find(key);
+		if (m_index.end() == it || isStale(*it->second)) {
+			m_misses.fetch_add(1UL, std::memory_order_relaxed);
+			return NULL;
+		}
+
+		// only written when it changes, so readers don't fight over the line
+		if (!it->second->m_used.load(std::memory_order_relaxed))
+			it->second->m_used.store(true, std::memory_order_relaxed);
+
+		m_hits.fetch_add(1UL, std::memory_order_relaxed);
+		return &it->second->m_record;
+	}
+
+	// For updates: no statistics, and the record doesn't become recently used
+	R *peek(const CCallsign &key)
+	{
+		auto it = m_index.find(key);
+		return (m_index.end() == it) ? NULL : &it->second->m_record;
+	}
+
+	// Add a new record, or overwrite the old one, and restart its ttl. A
+	// record read back from a snapshot keeps the time it was last updated.
+	R *insert(const CCallsign &key, const R &record, time_t updated = 0)
+	{
+		if (0 == updated)
+			updated = ::time(NULL);
+
+		auto it = m_index.find(key);
+		if (m_index.end() != it) {
+			it->second->m_record = record;
+			it->second->m_time = updated;
+			m_list.splice(m_list.begin(), m_list, it->second);
+			return &it->second->m_record;
+		}
+
+		if (m_capacity && m_index.size() >= m_capacity)
+			evict();
+
+		m_list.emplace_front(key, updated, record);
+		m_index[key] = m_list.begin();
+		return &m_list.front().m_record;
+	}
+
+	// true if the record is there, but find() skips it because it's too old
+	bool hasExpired(const CCallsign &key) const
+	{
+		auto it = m_index.find(key);
+		return m_index.end() != it && isStale(*it->second);
+	}
+
+	// The record was changed in place, restart its ttl
+	void touch(const CCallsign &key)
+	{
+		auto it = m_index.find(key);
+		if (m_index.end() != it)
+			it->second->m_time = ::time(NULL);
+	}
+
+	// Drop the records that find() has been skipping, returns how many
+	unsigned int expire()
+	{
+		unsigned int count = 0U;
+
+		for (auto it = m_list.begin(); it != m_list.end(); ) {
+			if (isStale(*it)) {
+				m_index.erase(it->m_key);
+				it = m_list.erase(it);
+				count++;
+			} else
+				++it;
+		}
+
+		m_evictions += count;
+		return count;
+	}
+
+	// Visit every live record, least recently used first, so inserting them
+	// in the same order rebuilds the same list
+	template <typename F> void forEach(F func) const
+	{
+		for (auto it = m_list.rbegin(); it != m_list.rend(); ++it) {
+			if (!isStale(*it))
+				func(it->m_key, it->m_time, it->m_record);
+		}
+	}
+
+	unsigned int getCount() const
+	{
+		return m_index.size();
+	}
+
+	unsigned long getHits() const
+	{
+		return m_hits;
+	}
+
+	unsigned long getMisses() const
+	{
+		return m_misses;
+	}
+
+	unsigned long getEvictions() const
+	{
+		return m_evictions;
+	}
+
+private:
+	struct SEntry {
+		SEntry(const CCallsign &key, time_t time, const R &record) :
+		m_key(key),
+		m_time(time),
+		m_used(false),
+		m_record(record)
+		{
+		}
+
+		CCallsign m_key;
+		time_t    m_time;		// when the record was last updated
+		mutable std::atomic<bool> m_used;	// found since evict() last looked at it
+		R         m_record;
+	};
+
+	unsigned int  m_capacity;
+	unsigned int  m_ttl;
+	std::list<SEntry> m_list;	// most recently used first
+	std::unordered_map<CCallsign, typename std::list<SEntry>::iterator> m_index;
+	mutable std::atomic<unsigned long> m_hits;
+	mutable std::atomic<unsigned long> m_misses;
+	unsigned long m_evictions;
+
+	bool isStale(const SEntry &entry) const
+	{
+		return m_ttl && ::time(NULL) - entry.m_time > time_t(m_ttl);
+	}
+
+	void evict()
+	{
+		// Move the records that have been used to the front, once each
+		for (unsigned int n = m_index.size(); n > 0U; n--) {
+			SEntry &entry = m_list.back();
+			if (!entry.m_used.load(std::memory_order_relaxed) || isStale(entry))
+				break;
+
+			entry.m_used.store(false, std::memory_order_relaxed);
+			m_list.splice(m_list.begin(), m_list, std::prev(m_list.end()));
+		}
+
+		m_index.erase(m_list.back().m_key);
+		m_list.pop_back();
+		m_evictions++;
+	}
+};
@@ -46,6 +46,11 @@ bool CRemoteHandler::open()
 	return m_handler.open();
 }
 
+int CRemoteHandler::getFD() const
+{
+	return m_handler.getFD();
+}
+
 void CRemoteHandler::process()
 {
 	RPH_TYPE type = m_handler.readType();
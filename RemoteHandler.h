@@ -32,6 +32,8 @@ public:
 
 	bool open();
 
+	int getFD() const;
+
 	void process();
 
 	void close();
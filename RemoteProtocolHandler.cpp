@@ -57,6 +57,11 @@ bool CRemoteProtocolHandler::open()
 	return m_socket.open();
 }
 
+int CRemoteProtocolHandler::getFD() const
+{
+	return m_socket.getFD();
+}
+
 RPH_TYPE CRemoteProtocolHandler::readType()
 {
 	m_type = RPHT_NONE;
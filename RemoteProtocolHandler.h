@@ -50,6 +50,8 @@ public:
 
 	bool open();
 
+	int getFD() const;
+
 	RPH_TYPE readType();
 
 	std::string readRepeater();
@@ -19,34 +19,68 @@
 
 #include "RepeaterCache.h"
 
-CRepeaterCache::CRepeaterCache()
+// ircDDB only sends the repeaters with a non-standard gateway at SENDLIST
+// or when they change, so they never time out
+CRepeaterCache::CRepeaterCache() :
+m_cache(0U, 0U)
 {
 }
 
 CRepeaterCache::~CRepeaterCache()
 {
-	for (std::unordered_map<std::string, CRepeaterRecord *>::iterator it = m_cache.begin(); it != m_cache.end(); ++it)
-		delete it->second;
 }
 
-CRepeaterRecord* CRepeaterCache::find(const std::string& repeater)
+const CRepeaterRecord* CRepeaterCache::find(const CCallsign& repeater) const
 {
-	return m_cache[repeater];
+	return m_cache.find(repeater);
 }
 
-void CRepeaterCache::update(const std::string& repeater, const std::string& gateway)
+void CRepeaterCache::update(const CCallsign& repeater, const CCallsign& gateway)
 {
-	CRepeaterRecord* rec = m_cache[repeater];
+	// A brand new record, or an update of an existing one
+	m_cache.insert(repeater, CRepeaterRecord(repeater, gateway));
+}
+
+void CRepeaterCache::setLimits(unsigned int capacity)
+{
+	m_cache.setLimits(capacity, 0U);
+}
+
+struct SRepeaterSnapshot {
+	uint64_t m_repeater;
+	uint64_t m_gateway;
+	int64_t  m_updated;
+};
+
+void CRepeaterCache::save(CSnapshotWriter &snapshot, unsigned int section) const
+{
+	m_cache.forEach([&](const CCallsign &key, time_t updated, const CRepeaterRecord &rec) {
+		SRepeaterSnapshot s = { key.getValue(), rec.getGateway().getValue(), int64_t(updated) };
+		snapshot.add(section, &s, sizeof(SRepeaterSnapshot));
+	});
+}
+
+unsigned int CRepeaterCache::load(const CSnapshotReader &snapshot, unsigned int section)
+{
+	unsigned int count;
+	const SRepeaterSnapshot *s = snapshot.getSection<SRepeaterSnapshot>(section, count);
+
+	for (unsigned int i = 0U; i < count; i++) {
+		CCallsign repeater(CCallsign::fromValue(s[i].m_repeater));
+		m_cache.insert(repeater, CRepeaterRecord(repeater, CCallsign::fromValue(s[i].m_gateway)), time_t(s[i].m_updated));
+	}
 
-	if (rec == NULL)
-		// A brand new record is needed
-		m_cache[repeater] = new CRepeaterRecord(repeater, gateway);
-	else
-		// Update an existing record
-		rec->setGateway(gateway);
+	return count;
 }
 
 unsigned int CRepeaterCache::getCount() const
 {
-	return m_cache.size();
+	return m_cache.getCount();
+}
+
+void CRepeaterCache::getStats(unsigned long &hits, unsigned long &misses, unsigned long &evictions) const
+{
+	hits      = m_cache.getHits();
+	misses    = m_cache.getMisses();
+	evictions = m_cache.getEvictions();
 }
@@ -20,34 +20,37 @@
 #pragma once
 
 #include <string>
-#include <unordered_map>
+
+#include "SnapshotFile.h"
+#include "LRUCache.h"
+#include "Callsign.h"
 
 class CRepeaterRecord {
 public:
-	CRepeaterRecord(const std::string& repeater, const std::string& gateway) :
+	CRepeaterRecord(const CCallsign& repeater, const CCallsign& gateway) :
 	m_repeater(repeater),
 	m_gateway(gateway)
 	{
 	}
 
-	std::string getRepeater() const
+	CCallsign getRepeater() const
 	{
 		return m_repeater;
 	}
 
-	std::string getGateway() const
+	CCallsign getGateway() const
 	{
 		return m_gateway;
 	}
 
-	void setGateway(const std::string& gateway)
+	void setGateway(const CCallsign& gateway)
 	{
 		m_gateway = gateway;
 	}
 
 private:
-	std::string m_repeater;
-	std::string m_gateway;
+	CCallsign m_repeater;
+	CCallsign m_gateway;
 };
 
 class CRepeaterCache {
@@ -55,12 +58,19 @@ public:
 	CRepeaterCache();
 	~CRepeaterCache();
 
-	CRepeaterRecord* find(const std::string& repeater);
+	const CRepeaterRecord* find(const CCallsign& repeater) const;
+
+	void update(const CCallsign& repeater, const CCallsign& gateway);
+
+	void setLimits(unsigned int capacity);
 
-	void update(const std::string& repeater, const std::string& gateway);
+	// Snapshots for a warm restart
+	void save(CSnapshotWriter &snapshot, unsigned int section) const;
+	unsigned int load(const CSnapshotReader &snapshot, unsigned int section);
 
 	unsigned int getCount() const;
+	void getStats(unsigned long &hits, unsigned long &misses, unsigned long &evictions) const;
 
 private:
-	std::unordered_map<std::string, CRepeaterRecord *> m_cache;
+	CLRUCache<CRepeaterRecord> m_cache;
 };
@@ -99,8 +99,14 @@ bool CSGSApp::createThread()
 	config.getIrcDDB(hostname, username, password);
 	printf("ircDDB host set to %s, username set to %s\n", hostname.c_str(), username.c_str());
 
+	std::string snapshot(config.getSnapshot());
+	if (snapshot.size())
+		m_thread->setSnapshot(snapshot);
+
 	if (hostname.size() && username.size()) {
 		CIRCDDB *ircDDB = new CIRCDDBClient(hostname, 9007U, username, password, std::string("linux_SmartGroupServer") + std::string("-") + VERSION, address);
+		if (snapshot.size())
+			ircDDB->loadTable(snapshot + "/" + IRCDDB_SNAPSHOT_FILE_NAME);
 		bool res = ircDDB->open();
 		if (!res) {
 			printf("Cannot initialise the ircDDB protocol handler\n");
@@ -136,6 +142,12 @@ bool CSGSApp::createThread()
 	printf("Remote enabled set to %d, port set to %u\n", int(remoteEnabled), remotePort);
 	m_thread->setRemote(remoteEnabled, remotePassword, remotePort);
 
+	m_thread->setWorkers(config.getWorkers());
+	m_thread->setReportWindow(config.getReportWindow());
+
+	unsigned int cacheUsers, cacheRepeaters, cacheGateways, cacheHours;
+	config.getCache(cacheUsers, cacheRepeaters, cacheGateways, cacheHours);
+	m_thread->setCache(cacheUsers, cacheRepeaters, cacheGateways, cacheHours);
 	m_thread->setAddress(address);
 	m_thread->setCallsign(CallSign);
 
@@ -23,7 +23,13 @@
 #include "SGSConfig.h"
 
 
-CSGSConfig::CSGSConfig(const std::string &pathname)
+CSGSConfig::CSGSConfig(const std::string &pathname) :
+m_workers(0U),
+m_cacheUsers(100000U),
+m_cacheRepeaters(20000U),
+m_cacheGateways(20000U),
+m_cacheHours(24U),
+m_ircddbReport(60U)
 {
 
 	if (pathname.size() < 1) {
@@ -51,6 +57,10 @@ CSGSConfig::CSGSConfig(const std::string &pathname)
 	CUtils::ToUpper(m_callsign);
 	get_value(cfg, "gateway.address", m_address, 0, 20, "");
 	printf("GATEWAY: callsign='%s' address='%s'\n", m_callsign.c_str(), m_address.c_str());
+	int workers;
+	get_value(cfg, "gateway.workers", workers, 0, 16, 0);
+	m_workers = (unsigned int)workers;
+	printf("GATEWAY: workers=%u\n", m_workers);
 	if (! get_value(cfg, "ircddb.hostname", m_ircddbHostname, 5, 30, "rr.openquad.net"))
 		return;
 	if (! get_value(cfg, "ircddb.username", m_ircddbUsername, 3, 8, ""))
@@ -61,6 +71,10 @@ CSGSConfig::CSGSConfig(const std::string &pathname)
 		CUtils::ToUpper(m_ircddbUsername);
 	get_value(cfg, "ircddb.password", m_ircddbPassword, 1, 30, "");
 	printf("IRCDDB: host='%s' user='%s' password='%s'\n", m_ircddbHostname.c_str(), m_ircddbUsername.c_str(), m_ircddbPassword.c_str());
+	int report;
+	get_value(cfg, "ircddb.report", report, 0, 600, 60);
+	m_ircddbReport = (unsigned int)report;
+	printf("IRCDDB: report=%u\n", m_ircddbReport);
 
 	// module parameters
 	for (int i=0; i<cfg.lookup("module").getLength(); i++) {
@@ -160,11 +174,24 @@ CSGSConfig::CSGSConfig(const std::string &pathname)
 		m_module.push_back(pmod);
 	}
 
+	// cache limits
+	int ivalue;
+	get_value(cfg, "cache.users", ivalue, 1000, 10000000, 100000);
+	m_cacheUsers = (unsigned int)ivalue;
+	get_value(cfg, "cache.repeaters", ivalue, 100, 1000000, 20000);
+	m_cacheRepeaters = (unsigned int)ivalue;
+	get_value(cfg, "cache.gateways", ivalue, 100, 1000000, 20000);
+	m_cacheGateways = (unsigned int)ivalue;
+	get_value(cfg, "cache.hours", ivalue, 0, 720, 24);
+	m_cacheHours = (unsigned int)ivalue;
+	printf("CACHE: users=%u repeaters=%u gateways=%u hours=%u\n", m_cacheUsers, m_cacheRepeaters, m_cacheGateways, m_cacheHours);
+	if (get_value(cfg, "cache.snapshot", m_cacheSnapshot, 0, 200, "") && m_cacheSnapshot.size())
+		printf("CACHE: snapshot directory=%s\n", m_cacheSnapshot.c_str());
+
 	// remote control
 	get_value(cfg, "remote.enabled", m_remoteEnabled, false);
 	if (m_remoteEnabled) {
 		get_value(cfg, "remote.password", m_remotePassword, 6, 30, "");
-		int ivalue;
 		get_value(cfg, "remote.port", ivalue, 1000, 65000, 39999);
 		m_remotePort = (unsigned int)ivalue;
 		printf("Remote enabled: password='%s', port=%d\n", m_remotePassword.c_str(), m_remotePort);
@@ -253,6 +280,29 @@ void CSGSConfig::getGroup(unsigned int mod, std::string& band, std::string& call
 	reflector      = m_module[mod]->reflector;
 }
 
+unsigned int CSGSConfig::getReportWindow() const
+{
+	return m_ircddbReport;
+}
+
+unsigned int CSGSConfig::getWorkers() const
+{
+	return m_workers;
+}
+
+void CSGSConfig::getCache(unsigned int &users, unsigned int &repeaters, unsigned int &gateways, unsigned int &hours) const
+{
+	users     = m_cacheUsers;
+	repeaters = m_cacheRepeaters;
+	gateways  = m_cacheGateways;
+	hours     = m_cacheHours;
+}
+
+std::string CSGSConfig::getSnapshot() const
+{
+	return m_cacheSnapshot;
+}
+
 void CSGSConfig::getRemote(bool& enabled, std::string& password, unsigned int& port) const
 {
 	enabled  = m_remoteEnabled;
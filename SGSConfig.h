@@ -44,11 +44,17 @@ public:
 	void getGateway(std::string &callsign, std::string &address) const;
 
 	void getIrcDDB(std::string &hostname, std::string &username, std::string &password) const;
+	unsigned int getReportWindow() const;
 
 	void getGroup(unsigned int mod, std::string &band, std::string &callsign, std::string &logoff, std::string &info, std::string &permanent, unsigned int &userTimeout, CALLSIGN_SWITCH &callsignSwitch, bool &txMsgSwitch, std::string &reflector) const;
 
 	void getRemote(bool &enabled, std::string &password, unsigned int &port) const;
 
+	unsigned int getWorkers() const;
+
+	void getCache(unsigned int &users, unsigned int &repeaters, unsigned int &gateways, unsigned int &hours) const;
+	std::string getSnapshot() const;
+
 	unsigned int getModCount();
 	unsigned int getLinkCount(const char *type);
 
@@ -60,9 +66,16 @@ private:
 	std::string m_fileName;
 	std::string m_callsign;
 	std::string m_address;
+	unsigned int m_workers;
+	unsigned int m_cacheUsers;
+	unsigned int m_cacheRepeaters;
+	unsigned int m_cacheGateways;
+	unsigned int m_cacheHours;
+	std::string m_cacheSnapshot;
 	std::string m_ircddbHostname;
 	std::string m_ircddbUsername;
 	std::string m_ircddbPassword;
+	unsigned int m_ircddbReport;
 	std::vector<struct Smodule *> m_module;
 
 	bool m_remoteEnabled;
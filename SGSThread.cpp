@@ -39,6 +39,10 @@
 
 const unsigned int REMOTE_DUMMY_PORT = 65015U;
 
+// ircDDB replies are taken this many at a time, for up to this long each time round the loop
+const unsigned int IRCDDB_BATCH = 64U;
+const unsigned int IRCDDB_BUDGET_US = 2000U;
+
 CSGSThread::CSGSThread(unsigned int countDExtra, unsigned int countDCS) :
 m_countDExtra(countDExtra),
 m_countDCS(countDCS),
@@ -49,13 +53,25 @@ m_address(),
 m_g2Handler(NULL),
 m_irc(NULL),
 m_cache(),
+m_resolver(&m_cache),
+m_relink(false),
+m_lookup(&m_cache),
 m_logEnabled(false),
-m_statusTimer(1000U, 1U),		// 1 second
+m_statusTimer(this, 1U),		// 1 second
+m_cacheTimer(this, 60U * 60U),	// 1 hour
+m_snapshot(),
+m_snapshotTimer(this, 10U * 60U),	// 10 minutes
+m_snapshotWriter(),
 m_lastStatus(IS_DISCONNECTED),
 m_remoteEnabled(false),
 m_remotePassword(),
 m_remotePort(0U),
-m_remote(NULL)
+m_remote(NULL),
+m_epoll(),
+m_workerCount(0U),
+m_reportWindow(60U),
+m_workers(),
+m_replies()
 {
 	CHeaderData::initialise();
 	CG2Handler::initialise(0);
@@ -83,6 +99,19 @@ void CSGSThread::run()
 		m_g2Handler = NULL;
 	}
 
+	if (!m_epoll.open()) {
+		printf("Could not open the epoll instance\n");
+		if (m_g2Handler) {
+			m_g2Handler->close();
+			delete m_g2Handler;
+			m_g2Handler = NULL;
+		}
+		return;
+	}
+
+	if (m_g2Handler)
+		m_epoll.add(m_g2Handler->getFD(), ES_G2, G2_DV_PORT);
+
 	// Wait here until we have the essentials to run
 	while (!m_killed && (m_g2Handler == NULL || m_irc == NULL || 0==m_callsign.size()))
 		std::this_thread::sleep_for(std::chrono::milliseconds(500));
@@ -94,10 +123,20 @@ void CSGSThread::run()
 
 	printf("Starting the Smart Group Server thread\n");
 
+	// The host files are loaded afterwards, so they override anything in the snapshot
+	if (m_snapshot.size()) {
+		m_cache.load(m_snapshot + "/" + CACHE_SNAPSHOT_FILE_NAME);
+		m_resolver.setCacheFile(m_snapshot + "/" + HOSTS_SNAPSHOT_FILE_NAME);
+	}
+
+	// The reflectors are resolved in the background while we get going
 	loadReflectors(DEXTRA_HOSTS_FILE_NAME, DP_DEXTRA);
 	loadReflectors(DCS_HOSTS_FILE_NAME, DP_DCS);
+	m_resolver.start();
 	CDExtraProtocolHandlerPool dextraPool(0, m_address);
 	CDCSProtocolHandlerPool dcsPool(DCS_PORT, m_address);
+	dextraPool.setEpoll(&m_epoll);
+	dcsPool.setEpoll(&m_epoll);
 
 	CG2Handler::setG2ProtocolHandler(m_g2Handler);
 
@@ -110,45 +149,73 @@ void CSGSThread::run()
 	CGroupHandler::setGateway(m_callsign);
 	CGroupHandler::setG2Handler(m_g2Handler);
 	CGroupHandler::setIRC(m_irc);
-	if (m_countDExtra || m_countDCS)
+	m_lookup.setIRC(m_irc);
+	CGroupHandler::setLookup(&m_lookup);
+	CGroupHandler::setReportWindow(m_reportWindow);
+
+	// Shard the fan-out of the groups across the worker threads
+	for (unsigned int i = 0U; i < m_workerCount; i++) {
+		CGroupWorker *worker = new CGroupWorker(i, m_g2Handler);
+		worker->start();
+		m_workers.push_back(worker);
+	}
+	CGroupHandler::setWorkers(m_workers);
+
+	if (m_countDExtra || m_countDCS) {
 		CGroupHandler::link();
+		m_relink = true;
+	}
 
 	if (m_remoteEnabled && m_remotePassword.size() && m_remotePort > 0U) {
 		m_remote = new CRemoteHandler(m_remotePassword, m_remotePort);
 		bool res = m_remote->open();
-		if (!res) {
+		if (res)
+			m_epoll.add(m_remote->getFD(), ES_REMOTE, m_remotePort);
+		else {
 			delete m_remote;
 			m_remote = NULL;
 		}
 	}
 
-	time_t start;
-	time(&start);
+	// Wake up as soon as ircDDB has a reply, rather than at the next timeout
+	m_epoll.add(m_irc->getReplyFD(), ES_IRCDDB, 0U);
 
 	m_statusTimer.start();
+	m_cacheTimer.start();
+	if (m_snapshot.size())
+		m_snapshotTimer.start();
 
 	try {
+		bool backlog = false;
 		while (!m_killed) {
-			processIrcDDB();
-			processG2();
-			processDExtra(&dextraPool);
-			processDCS(&dcsPool);
-			if (m_remote != NULL)
-				m_remote->process();
-
-			time_t now;
-			time(&now);
-			unsigned long ms = (unsigned long)(1000.0 * difftime(now, start));
-			time(&start);
-
-			m_statusTimer.clock(ms);
-
-			CG2Handler::clock(ms);
-			CGroupHandler::clock(ms);
-			CDExtraHandler::clock(ms);
-			CDCSHandler::clock(ms);
-
-			std::this_thread::sleep_for(std::chrono::milliseconds(TIME_PER_TIC_MS));
+			// Sleep until a socket is readable, or the next timer is due, unless ircDDB replies are waiting
+			int count = m_epoll.wait(backlog ? 0U : CTimerWheel::getTimeout(MAX_WAIT_MS));
+			for (int i = 0; i < count; i++) {
+				switch (m_epoll.getSource(i)) {
+					case ES_G2:
+						processG2();
+						break;
+					case ES_DEXTRA:
+						processDExtra(&dextraPool, m_epoll.getPort(i));
+						break;
+					case ES_DCS:
+						processDCS(&dcsPool, m_epoll.getPort(i));
+						break;
+					case ES_REMOTE:
+						if (m_remote != NULL)
+							m_remote->process();
+						break;
+					case ES_IRCDDB:
+						// processIrcDDB() below takes the replies
+						m_irc->clearReplyFD();
+						break;
+				}
+			}
+
+			backlog = processIrcDDB();
+
+			// Only the timers that are due are touched
+			CTimerWheel::clock();
 		}
 	}
 	catch (std::exception& e) {
@@ -160,6 +227,18 @@ void CSGSThread::run()
 
 	printf("Stopping the Smart Group Server thread\n");
 
+	m_resolver.stop();
+
+	m_cache.printStats();
+	m_lookup.printStats();
+
+	// Wait for any snapshot still being written, then write the last one
+	if (m_snapshotWriter.valid())
+		m_snapshotWriter.get();
+	saveSnapshot();
+	if (m_snapshotWriter.valid())
+		m_snapshotWriter.get();
+
 	// Unlink from all reflectors
 	CDExtraHandler::unlink();
 	dextraPool.close();
@@ -168,6 +247,13 @@ void CSGSThread::run()
 	CDCSHandler::unlink();
 	dcsPool.close();
 
+	// The workers send on the G2 socket, so they have to finish first
+	while (m_workers.size()) {
+		m_workers.back()->stop();
+		delete m_workers.back();
+		m_workers.pop_back();
+	}
+
 	m_g2Handler->close();
 	delete m_g2Handler;
 
@@ -178,6 +264,8 @@ void CSGSThread::run()
 		m_remote->close();
 		delete m_remote;
 	}
+
+	m_epoll.close();
 }
 
 void CSGSThread::kill()
@@ -198,6 +286,59 @@ void CSGSThread::setAddress(const std::string& address)
 	m_address = address;
 }
 
+void CSGSThread::setWorkers(unsigned int count)
+{
+	if (!m_stopped)
+		return;
+
+	m_workerCount = count;
+}
+
+void CSGSThread::setReportWindow(unsigned int window)
+{
+	if (!m_stopped)
+		return;
+
+	m_reportWindow = window;
+}
+
+void CSGSThread::setCache(unsigned int users, unsigned int repeaters, unsigned int gateways, unsigned int hours)
+{
+	m_cache.setLimits(users, repeaters, gateways, hours * 60U * 60U);
+}
+
+void CSGSThread::setSnapshot(const std::string& directory)
+{
+	m_snapshot = directory;
+}
+
+// Only the copies are made here, the files are written on another thread
+void CSGSThread::saveSnapshot()
+{
+	if (m_snapshot.empty())
+		return;
+
+	// The last one is still being written, this one can wait for the next time
+	if (m_snapshotWriter.valid() && std::future_status::ready != m_snapshotWriter.wait_for(std::chrono::seconds(0)))
+		return;
+
+	CSnapshotWriter *cache = m_cache.save();
+	CSnapshotWriter *table = (m_irc != NULL) ? m_irc->saveTable() : NULL;
+
+	m_snapshotWriter = std::async(std::launch::async, &CSGSThread::writeSnapshot, m_snapshot, cache, table);
+}
+
+void CSGSThread::writeSnapshot(const std::string directory, CSnapshotWriter *cache, CSnapshotWriter *table)
+{
+	cache->save(directory + "/" + CACHE_SNAPSHOT_FILE_NAME);
+	delete cache;
+
+	if (table != NULL) {
+		table->save(directory + "/" + IRCDDB_SNAPSHOT_FILE_NAME);
+		delete table;
+	}
+}
+
 void CSGSThread::addGroup(const std::string& callsign, const std::string& logoff, const std::string& repeater, const std::string& infoText, const std::string& permanent, unsigned int userTimeout, CALLSIGN_SWITCH callsignSwitch, bool txMsgSwitch, const std::string& reflector)
 {
 	CGroupHandler::add(callsign, logoff, repeater, infoText, permanent, userTimeout, callsignSwitch, txMsgSwitch, reflector);
@@ -223,100 +364,114 @@ void CSGSThread::setRemote(bool enabled, const std::string& password, unsigned i
 	}
 }
 
-void CSGSThread::processIrcDDB()
+void CSGSThread::timerExpired(CWheelTimer &timer)
 {
+	if (&timer == &m_cacheTimer) {
+		m_cache.expire();
+		m_cache.printStats();
+		m_lookup.printStats();
+		m_lookup.clean();
+		m_cacheTimer.start();
+		return;
+	}
+
+	if (&timer == &m_snapshotTimer) {
+		saveSnapshot();
+		m_snapshotTimer.start();
+		return;
+	}
+
 	// Once per second
-	if (m_statusTimer.hasExpired()) {
-		int status = m_irc->getConnectionState();
-		switch (status) {
-			case 0:
-			case 10:
-				if (m_lastStatus != IS_DISCONNECTED) {
-					printf("Disconnected from ircDDB\n");
-					m_lastStatus = IS_DISCONNECTED;
-				}
-				break;
-			case 7:
-				if (m_lastStatus != IS_CONNECTED) {
-					printf("Connected to ircDDB\n");
-					m_lastStatus = IS_CONNECTED;
-				}
-				break;
-			default:
-				if (m_lastStatus != IS_CONNECTING) {
-					printf("Connecting to ircDDB\n");
-					m_lastStatus = IS_CONNECTING;
-				}
-				break;
-		}
+	int status = m_irc->getConnectionState();
+	switch (status) {
+		case 0:
+		case 10:
+			if (m_lastStatus != IS_DISCONNECTED) {
+				printf("Disconnected from ircDDB\n");
+				m_lastStatus = IS_DISCONNECTED;
+			}
+			break;
+		case 7:
+			if (m_lastStatus != IS_CONNECTED) {
+				printf("Connected to ircDDB\n");
+				m_lastStatus = IS_CONNECTED;
+			}
+			break;
+		default:
+			if (m_lastStatus != IS_CONNECTING) {
+				printf("Connecting to ircDDB\n");
+				m_lastStatus = IS_CONNECTING;
+			}
+			break;
+	}
 
-		m_statusTimer.start();
+	// Retry the links while the host files are still being resolved, and once more after
+	if (m_relink) {
+		bool busy = m_resolver.isBusy();
+		m_relink = CGroupHandler::relink() && busy;
 	}
 
-	// Process all incoming ircDDB messages, updating the caches
+	m_statusTimer.start();
+}
+
+// Returns true if it ran out of time with replies still waiting
+bool CSGSThread::processIrcDDB()
+{
+	std::chrono::steady_clock::time_point deadline = std::chrono::steady_clock::now() + std::chrono::microseconds(IRCDDB_BUDGET_US);
+
+	// Process the incoming ircDDB messages a batch at a time, updating the caches
 	for (;;) {
-		IRCDDB_RESPONSE_TYPE type = m_irc->getMessageType();
+		unsigned int count = m_irc->receiveReplies(m_replies, IRCDDB_BATCH);
+		if (0U == count)
+			return false;
 
-		switch (type) {
-			case IDRT_NONE:
-				return;
+		m_cache.update(m_replies, count);
 
-			case IDRT_USER: {
-					std::string user, repeater, gateway, address, timestamp;
-					bool res = m_irc->receiveUser(user, repeater, gateway, address, timestamp);
-					if (!res)
-						break;
+		// The cache is unlocked again before anybody is told
+		for (unsigned int i = 0U; i < count; i++) {
+			const CIRCDDBReply &reply = m_replies[i];
 
-					if (address.size()) {
-						//printf("USER: %s %s %s %s\n", user.c_str(), repeater.c_str(), gateway.c_str(), address.c_str());
-						m_cache.updateUser(user, repeater, gateway, address, timestamp, DP_DEXTRA, false, false);
-					//} else {
-					//	printf("USER: %s has no IP address!\n", user.c_str());
-					}
-				}
-				break;
+			switch (reply.m_type) {
+				case IDRT_USER:
+					// an empty address is ircDDB's "not found"
+					m_lookup.replied(reply.m_user, reply.m_address.size() > 0U);
 
-			case IDRT_REPEATER: {
-					std::string repeater, gateway, address;
-					bool res = m_irc->receiveRepeater(repeater, gateway, address);
-					if (!res)
-						break;
+					if (reply.m_address.size())
+						CGroupHandler::cacheUpdated(reply.m_user, reply.m_repeater, reply.m_gateway);
+					break;
 
-					if (address.size()) {
-//						printf("REPEATER: %s %s %s\n", repeater.c_str(), gateway.c_str(), address.c_str());
-						m_cache.updateRepeater(repeater, gateway, address, DP_DEXTRA, false, false);
-//					} else {
-//						printf("REPEATER: %s NOT FOUND\n", repeater.c_str());
-					}
-				}
-				break;
+				case IDRT_REPEATER:
+					if (reply.m_address.size())
+						CGroupHandler::cacheUpdated("", reply.m_repeater, reply.m_gateway);
+					break;
 
-			case IDRT_GATEWAY: {
-					std::string gateway, address;
-					bool res = m_irc->receiveGateway(gateway, address);
-					if (!res)
-						break;
+				case IDRT_GATEWAY:
+					CDExtraHandler::gatewayUpdate(reply.m_gateway, reply.m_address);
 
-					CDExtraHandler::gatewayUpdate(gateway, address);
+					CDCSHandler::gatewayUpdate(reply.m_gateway, reply.m_address);
 
-					CDCSHandler::gatewayUpdate(gateway, address);
+					if (0 == reply.m_address.size())
+						CGroupHandler::cacheUpdated("", "", reply.m_gateway);
+					break;
 
-					if (0 == address.size()) {
-//						printf("GATEWAY: %s %s\n", gateway.c_str(), address.c_str());
-						m_cache.updateGateway(gateway, address, DP_DEXTRA, false, false);
-//					} else {
-//						printf("GATEWAY: %s NOT FOUND\n", gateway.c_str());
-					}
-				}
-				break;
+				default:
+					break;
+			}
 		}
+
+		if (count < IRCDDB_BATCH)
+			return false;
+
+		// Leave the rest for the next time round, so the voice frames aren't held up
+		if (std::chrono::steady_clock::now() >= deadline)
+			return true;
 	}
 }
 
-void CSGSThread::processDExtra(CDExtraProtocolHandlerPool *dextraPool)
+void CSGSThread::processDExtra(CDExtraProtocolHandlerPool *dextraPool, unsigned int port)
 {
 	for (;;) {
-		DEXTRA_TYPE type = dextraPool->read();
+		DEXTRA_TYPE type = dextraPool->read(port);
 
 		switch (type) {
 			case DE_NONE:
@@ -341,31 +496,28 @@ void CSGSThread::processDExtra(CDExtraProtocolHandlerPool *dextraPool)
 				break;
 
 			case DE_HEADER: {
-					CHeaderData* header = dextraPool->newHeader();
-					if (header != NULL) {
-						// printf("DExtra header - My: %s/%s  Your: %s  Rpt1: %s  Rpt2: %s\n", header->getMyCall1().c_str(), header->getMyCall2().c_str(), header->getYourCall().c_str(), header->getRptCall1().c_str(), header->getRptCall2().c_str());
-						CDExtraHandler::process(*header);
-						delete header;
+					CHeaderData header;
+					if (dextraPool->readHeader(header)) {
+						// printf("DExtra header - My: %s/%s  Your: %s  Rpt1: %s  Rpt2: %s\n", header.getMyCall1().c_str(), header.getMyCall2().c_str(), header.getYourCall().c_str(), header.getRptCall1().c_str(), header.getRptCall2().c_str());
+						CDExtraHandler::process(header);
 					}
 				}
 				break;
 
 			case DE_AMBE: {
-					CAMBEData* data = dextraPool->newAMBE();
-					if (data != NULL) {
-						CDExtraHandler::process(*data);
-						delete data;
-					}
+					CAMBEData data;
+					if (dextraPool->readAMBE(data))
+						CDExtraHandler::process(data);
 				}
 				break;
 		}
 	}
 }
 
-void CSGSThread::processDCS(CDCSProtocolHandlerPool *dcsPool)
+void CSGSThread::processDCS(CDCSProtocolHandlerPool *dcsPool, unsigned int port)
 {
 	for (;;) {
-		DCS_TYPE type = dcsPool->read();
+		DCS_TYPE type = dcsPool->read(port);
 
 		switch (type) {
 			case DC_NONE:
@@ -390,11 +542,11 @@ void CSGSThread::processDCS(CDCSProtocolHandlerPool *dcsPool)
 				break;
 
 			case DC_DATA: {
-					CAMBEData* data = dcsPool->readData();
-					if (data != NULL) {
-						// printf("DCS header - My: %s/%s  Your: %s  Rpt1: %s  Rpt2: %s\n", header->getMyCall1().c_str(), header->getMyCall2().c_str(), header->getYourCall().c_str(), header->getRptCall1().c_str(), header->getRptCall2().c_str());
-						CDCSHandler::process(*data);
-						delete data;
+					CHeaderData header;
+					CAMBEData data;
+					if (dcsPool->readData(header, data)) {
+						// printf("DCS header - My: %s/%s  Your: %s  Rpt1: %s  Rpt2: %s\n", header.getMyCall1().c_str(), header.getMyCall2().c_str(), header.getYourCall().c_str(), header.getRptCall1().c_str(), header.getRptCall2().c_str());
+						CDCSHandler::process(header, data);
 					}
 				}
 				break;
@@ -412,21 +564,18 @@ void CSGSThread::processG2()
 				return;
 
 			case GT_HEADER: {
-					CHeaderData* header = m_g2Handler->readHeader();
-					if (header != NULL) {
-//printf("G2 header - My: %s/%s  Your: %s  Rpt1: %s  Rpt2: %s  Flags: %02X %02X %02X\n", header->getMyCall1().c_str(), header->getMyCall2().c_str(), header->getYourCall().c_str(), header->getRptCall1().c_str(), header->getRptCall2().c_str(), header->getFlag1(), header->getFlag2(), header->getFlag3());
-						CG2Handler::process(*header);
-						delete header;
+					CHeaderData header;
+					if (m_g2Handler->readHeader(header)) {
+//printf("G2 header - My: %s/%s  Your: %s  Rpt1: %s  Rpt2: %s  Flags: %02X %02X %02X\n", header.getMyCall1().c_str(), header.getMyCall2().c_str(), header.getYourCall().c_str(), header.getRptCall1().c_str(), header.getRptCall2().c_str(), header.getFlag1(), header.getFlag2(), header.getFlag3());
+						CG2Handler::process(header);
 					}
 				}
 				break;
 
 			case GT_AMBE: {
-					CAMBEData* data = m_g2Handler->readAMBE();
-					if (data != NULL) {
-						CG2Handler::process(*data);
-						delete data;
-					}
+					CAMBEData data;
+					if (m_g2Handler->readAMBE(data))
+						CG2Handler::process(data);
 				}
 				break;
 		}
@@ -463,18 +612,13 @@ void CSGSThread::loadReflectors(const std::string fname, DSTAR_PROTOCOL dstarPro
 					std::string name(first);
 					name.resize(7, ' ');
 					name.push_back('G');
-					struct hostent *he = gethostbyname(second);
-					if (he) {
-						count++;
-						std::string address(inet_ntoa(*(struct in_addr*)(he->h_addr_list[0])));
-						m_cache.updateGateway(name, address, dstarProtocol, third?1:0, true);
-//						printf("reflector:%s, address:%s lock:%s\n", name.c_str(), address.c_str(), third?"true":"false");
-					}
+					m_resolver.add(name, second, dstarProtocol, third != NULL);
+					count++;
 				}
 			}
 		}
 		hostfile.getline(line, 256);
 	}
 
-	printf("Loaded %u of %u %s reflectors\n", count, tries, DP_DEXTRA==dstarProtocol?"DExtra":"DCS");
+	printf("Queued %u of %u %s reflectors\n", count, tries, DP_DEXTRA==dstarProtocol?"DExtra":"DCS");
 }
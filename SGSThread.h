@@ -19,24 +19,38 @@
 
 #pragma once
 
+#include <future>
 #include <string>
+#include <vector>
 
 #include "DExtraProtocolHandlerPool.h"		// DEXTRA_LINK
 #include "DCSProtocolHandlerPool.h"			// DCS_LINK
 #include "G2ProtocolHandler.h"
+#include "GroupWorker.h"
 #include "RemoteHandler.h"
 #include "CacheManager.h"
+#include "HostResolver.h"
+#include "UserLookup.h"
 #include "IRCDDB.h"
-#include "Timer.h"
+#include "Epoll.h"
+#include "TimerWheel.h"
 #include "Defs.h"
 
-class CSGSThread {
+const std::string CACHE_SNAPSHOT_FILE_NAME("cache.dat");
+const std::string IRCDDB_SNAPSHOT_FILE_NAME("ircddb.dat");
+const std::string HOSTS_SNAPSHOT_FILE_NAME("hosts.txt");
+
+class CSGSThread : public ITimerCallback {
 public:
 	CSGSThread(unsigned int countDExtra, unsigned int countDCS);
 	virtual ~CSGSThread();
 
 	virtual void setCallsign(const std::string& callsign);
 	virtual void setAddress(const std::string& address);
+	virtual void setWorkers(unsigned int count);
+	virtual void setReportWindow(unsigned int window);
+	virtual void setCache(unsigned int users, unsigned int repeaters, unsigned int gateways, unsigned int hours);
+	virtual void setSnapshot(const std::string& directory);
 
 	virtual void addGroup(const std::string& callsign, const std::string& logoff, const std::string& repeater, const std::string& infoText, const std::string& permanent,
 							unsigned int userTimeout, CALLSIGN_SWITCH callsignSwitch, bool txMsgSwitch, const std::string& reflector);
@@ -47,6 +61,8 @@ public:
 	virtual void run();
 	virtual void kill();
 
+	virtual void timerExpired(CWheelTimer &timer);
+
 private:
 	unsigned int m_countDExtra;
 	unsigned int m_countDCS;
@@ -58,19 +74,33 @@ private:
 	CG2ProtocolHandler *m_g2Handler;
 	CIRCDDB            *m_irc;
 	CCacheManager 		m_cache;
+	CHostResolver		m_resolver;
+	bool				m_relink;		// groups are waiting for their reflectors to resolve
+	CUserLookup			m_lookup;
 	bool				m_logEnabled;
-	CTimer				m_statusTimer;
+	CWheelTimer			m_statusTimer;
+	CWheelTimer			m_cacheTimer;
+	std::string			m_snapshot;
+	CWheelTimer			m_snapshotTimer;
+	std::future<void>	m_snapshotWriter;
 	IRCDDB_STATUS		m_lastStatus;
 	bool				m_remoteEnabled;
 	std::string			m_remotePassword;
 	unsigned int		m_remotePort;
 	CRemoteHandler     *m_remote;
+	CEpoll              m_epoll;
+	unsigned int        m_workerCount;
+	unsigned int        m_reportWindow;
+	std::vector<CGroupWorker *> m_workers;
+	std::vector<CIRCDDBReply>   m_replies;
 
-	void processIrcDDB();
+	bool processIrcDDB();
 	void processG2();
 	void loadReflectors(const std::string fname, DSTAR_PROTOCOL dstarProtocol);
+	void saveSnapshot();
+	static void writeSnapshot(const std::string directory, CSnapshotWriter *cache, CSnapshotWriter *table);
 
-	void processDExtra(CDExtraProtocolHandlerPool *dextraPool);
-	void processDCS(CDCSProtocolHandlerPool *dcsPool);
+	void processDExtra(CDExtraProtocolHandlerPool *dextraPool, unsigned int port);
+	void processDCS(CDCSProtocolHandlerPool *dcsPool, unsigned int port);
 };
 
@@ -0,0 +1,103 @@
+/*
+ *   Copyright (c) 2018 by Thomas A. Early N7TAE
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation; either version 2 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+
+
+#pragma once
+
+#include <atomic>
+#include <utility>
+
+// A bounded, lock-free ring for exactly one producer thread and one consumer thread.
+// The size is rounded up to a power of two. push() fails when the ring is full,
+// pop() fails when it is empty, neither ever blocks.
+template <class T> class CSPSCRing {
+public:
+	CSPSCRing(unsigned int size) :
+	m_buffer(NULL),
+	m_mask(0U),
+	m_head(0U),
+	m_tail(0U)
+	{
+		unsigned int n = 2U;
+		while (n < size)
+			n <<= 1;
+		m_mask = n - 1U;
+		m_buffer = new T[n];
+	}
+
+	~CSPSCRing()
+	{
+		delete[] m_buffer;
+	}
+
+	// Producer only
+	bool push(const T &item)
+	{
+		unsigned int head = m_head.load(std::memory_order_relaxed);
+		if (head - m_tail.load(std::memory_order_acquire) > m_mask)
+			return false;
+
+		m_buffer[head & m_mask] = item;
+		m_head.store(head + 1U, std::memory_order_release);
+
+		return true;
+	}
+
+	// Consumer only
+	bool pop(T &item)
+	{
+		unsigned int tail = m_tail.load(std::memory_order_relaxed);
+		if (tail == m_head.load(std::memory_order_acquire))
+			return false;
+
+		item = std::move(m_buffer[tail & m_mask]);
+		m_tail.store(tail + 1U, std::memory_order_release);
+
+		return true;
+	}
+
+	bool isEmpty() const
+	{
+		return m_head.load(std::memory_order_acquire) == m_tail.load(std::memory_order_acquire);
+	}
+
+	unsigned int getCount() const
+	{
+		return m_head.load(std::memory_order_acquire) - m_tail.load(std::memory_order_acquire);
+	}
+
+	unsigned int getSize() const
+	{
+		return m_mask + 1U;
+	}
+
+private:
+	CSPSCRing(const CSPSCRing &) = delete;
+	CSPSCRing &operator=(const CSPSCRing &) = delete;
+
+	T           *m_buffer;
+	unsigned int m_mask;
+
+	// Keep the two indices on their own cache lines so the threads don't share one.
+	// Padding rather than alignas, because operator new won't honour it before C++17.
+	char m_pad1[64];
+	std::atomic<unsigned int> m_head;	// written by the producer
+	char m_pad2[64];
+	std::atomic<unsigned int> m_tail;	// written by the consumer
+	char m_pad3[64];
+};
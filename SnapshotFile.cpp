@@ -0,0 +1,181 @@
+/*
+ *   Copyright (c) 2018 by Thomas A. Early N7TAE
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation; either version 2 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+
+
+#include <cstdio>
+#include <cstring>
+#include <cerrno>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "SnapshotFile.h"
+
+CSnapshotWriter::CSnapshotWriter(const char *magic, uint32_t version)
+{
+	::memset(&m_header, 0x00U, sizeof(SSnapshotHeader));
+	::memcpy(m_header.m_magic, magic, 4U);
+	m_header.m_version = version;
+}
+
+void CSnapshotWriter::add(unsigned int section, const void *record, unsigned int size)
+{
+	if (section >= SNAPSHOT_SECTIONS || (size & 0x07U) != 0U)
+		return;
+
+	if (m_header.m_count[section] > 0U && m_header.m_size[section] != size)
+		return;
+
+	m_header.m_size[section] = size;
+	m_header.m_count[section]++;
+
+	const unsigned char *p = (const unsigned char *)record;
+	m_data[section].insert(m_data[section].end(), p, p + size);
+}
+
+bool CSnapshotWriter::save(const std::string &fileName) const
+{
+	std::string tmpName(fileName + ".tmp");
+
+	int fd = ::open(tmpName.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+	if (fd < 0) {
+		printf("Cannot create snapshot %s, err=%s\n", tmpName.c_str(), ::strerror(errno));
+		return false;
+	}
+
+	SSnapshotHeader header(m_header);
+	header.m_time = int64_t(::time(NULL));
+
+	bool ok = ::write(fd, &header, sizeof(SSnapshotHeader)) == ssize_t(sizeof(SSnapshotHeader));
+	for (unsigned int i = 0U; ok && i < SNAPSHOT_SECTIONS; i++) {
+		size_t length = m_data[i].size();
+		size_t offset = 0U;
+		while (ok && offset < length) {
+			ssize_t n = ::write(fd, m_data[i].data() + offset, length - offset);
+			if (n <= 0)
+				ok = false;
+			else
+				offset += size_t(n);
+		}
+	}
+
+	// On disk before it replaces the old one, or a crash could leave neither
+	if (ok && ::fsync(fd) < 0)
+		ok = false;
+
+	if (::close(fd) < 0)
+		ok = false;
+
+	if (!ok) {
+		printf("Cannot write snapshot %s, err=%s\n", tmpName.c_str(), ::strerror(errno));
+		::unlink(tmpName.c_str());
+		return false;
+	}
+
+	if (::rename(tmpName.c_str(), fileName.c_str()) < 0) {
+		printf("Cannot rename snapshot to %s, err=%s\n", fileName.c_str(), ::strerror(errno));
+		::unlink(tmpName.c_str());
+		return false;
+	}
+
+	return true;
+}
+
+CSnapshotReader::CSnapshotReader() :
+m_map(NULL),
+m_length(0U),
+m_header(NULL)
+{
+	for (unsigned int i = 0U; i < SNAPSHOT_SECTIONS; i++)
+		m_section[i] = NULL;
+}
+
+CSnapshotReader::~CSnapshotReader()
+{
+	close();
+}
+
+bool CSnapshotReader::open(const std::string &fileName, const char *magic, uint32_t version)
+{
+	close();
+
+	int fd = ::open(fileName.c_str(), O_RDONLY);
+	if (fd < 0) {
+		if (errno != ENOENT)
+			printf("Cannot open snapshot %s, err=%s\n", fileName.c_str(), ::strerror(errno));
+		return false;
+	}
+
+	struct stat st;
+	if (::fstat(fd, &st) < 0 || size_t(st.st_size) < sizeof(SSnapshotHeader)) {
+		printf("Snapshot %s is too short\n", fileName.c_str());
+		::close(fd);
+		return false;
+	}
+
+	m_length = size_t(st.st_size);
+	void *map = ::mmap(NULL, m_length, PROT_READ, MAP_PRIVATE, fd, 0);
+	::close(fd);
+	if (MAP_FAILED == map) {
+		printf("Cannot map snapshot %s, err=%s\n", fileName.c_str(), ::strerror(errno));
+		m_length = 0U;
+		return false;
+	}
+
+	m_map    = (unsigned char *)map;
+	m_header = (const SSnapshotHeader *)m_map;
+
+	if (::memcmp(m_header->m_magic, magic, 4U) || m_header->m_version != version) {
+		printf("Snapshot %s has the wrong format, ignoring it\n", fileName.c_str());
+		close();
+		return false;
+	}
+
+	size_t offset = sizeof(SSnapshotHeader);
+	for (unsigned int i = 0U; i < SNAPSHOT_SECTIONS; i++) {
+		size_t length = size_t(m_header->m_count[i]) * m_header->m_size[i];
+		if ((m_header->m_size[i] & 0x07U) != 0U || length > m_length - offset) {
+			printf("Snapshot %s is corrupt, ignoring it\n", fileName.c_str());
+			close();
+			return false;
+		}
+
+		m_section[i] = m_map + offset;
+		offset += length;
+	}
+
+	return true;
+}
+
+void CSnapshotReader::close()
+{
+	if (m_map != NULL)
+		::munmap(m_map, m_length);
+
+	m_map    = NULL;
+	m_length = 0U;
+	m_header = NULL;
+	for (unsigned int i = 0U; i < SNAPSHOT_SECTIONS; i++)
+		m_section[i] = NULL;
+}
+
+time_t CSnapshotReader::getTime() const
+{
+	return (NULL == m_header) ? 0 : time_t(m_header->m_time);
+}
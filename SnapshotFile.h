@@ -0,0 +1,86 @@
+/*
+ *   Copyright (c) 2018 by Thomas A. Early N7TAE
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation; either version 2 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+
+
+#pragma once
+
+#include <cstdint>
+#include <ctime>
+#include <string>
+#include <vector>
+
+const unsigned int SNAPSHOT_SECTIONS = 4U;
+
+// The file starts with this header, followed by the records of each section
+// in turn. All records are a multiple of 8 bytes, so everything in a mapped
+// file is naturally aligned. The file is in host byte order.
+struct SSnapshotHeader {
+	char     m_magic[4];
+	uint32_t m_version;
+	int64_t  m_time;							// when it was written
+	uint32_t m_count[SNAPSHOT_SECTIONS];		// records in each section
+	uint32_t m_size[SNAPSHOT_SECTIONS];		// bytes in each record
+};
+
+// Collects fixed size records and writes them out in one go. The file is
+// written and synced under a temporary name and then renamed, so a reader
+// never sees a partial snapshot.
+class CSnapshotWriter {
+public:
+	CSnapshotWriter(const char *magic, uint32_t version);
+
+	void add(unsigned int section, const void *record, unsigned int size);
+
+	bool save(const std::string &fileName) const;
+
+private:
+	SSnapshotHeader m_header;
+	std::vector<unsigned char> m_data[SNAPSHOT_SECTIONS];
+};
+
+// Maps a snapshot read-only, the records are used in place
+class CSnapshotReader {
+public:
+	CSnapshotReader();
+	~CSnapshotReader();
+
+	bool open(const std::string &fileName, const char *magic, uint32_t version);
+	void close();
+
+	time_t getTime() const;
+
+	// NULL if the section is empty or its records aren't a T
+	template <typename T> const T *getSection(unsigned int section, unsigned int &count) const
+	{
+		count = 0U;
+		if (NULL == m_header || section >= SNAPSHOT_SECTIONS || m_header->m_size[section] != sizeof(T))
+			return NULL;
+
+		count = m_header->m_count[section];
+		return count ? (const T *)m_section[section] : NULL;
+	}
+
+private:
+	unsigned char         *m_map;
+	size_t                 m_length;
+	const SSnapshotHeader *m_header;
+	const unsigned char   *m_section[SNAPSHOT_SECTIONS];
+
+	CSnapshotReader(const CSnapshotReader &) = delete;
+	CSnapshotReader &operator=(const CSnapshotReader &) = delete;
+};
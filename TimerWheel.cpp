@@ -0,0 +1,238 @@
+/*
+ *   Copyright (c) 2018 by Thomas A. Early N7TAE
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation; either version 2 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+
+#include <chrono>
+
+#include "TimerWheel.h"
+
+CTimerNode   CTimerWheel::m_slots[WHEEL_LEVELS][WHEEL_SLOTS];
+uint64_t     CTimerWheel::m_now = 0U;
+unsigned int CTimerWheel::m_count = 0U;
+
+CTimerNode::CTimerNode() :
+m_prev(this),
+m_next(this)
+{
+}
+
+bool CTimerNode::isLinked() const
+{
+	return m_next != this;
+}
+
+void CTimerNode::unlink()
+{
+	m_prev->m_next = m_next;
+	m_next->m_prev = m_prev;
+	m_prev = m_next = this;
+}
+
+// add node to the end of the list that this node is the head of
+void CTimerNode::append(CTimerNode *node)
+{
+	node->m_prev = m_prev;
+	node->m_next = this;
+	m_prev->m_next = node;
+	m_prev = node;
+}
+
+CWheelTimer::CWheelTimer(ITimerCallback *owner, unsigned int secs, unsigned int msecs) :
+m_owner(owner),
+m_timeout(secs * 1000ULL + msecs),
+m_started(0U),
+m_deadline(0U)
+{
+}
+
+CWheelTimer::~CWheelTimer()
+{
+	stop();
+}
+
+void CWheelTimer::setTimeout(unsigned int secs, unsigned int msecs)
+{
+	m_timeout = secs * 1000ULL + msecs;
+
+	if (0U == m_timeout)
+		stop();
+}
+
+unsigned int CWheelTimer::getTimeout() const
+{
+	return (unsigned int)(m_timeout / 1000U);
+}
+
+unsigned int CWheelTimer::getTimer() const
+{
+	if (! isRunning())
+		return 0U;
+
+	return (unsigned int)((CTimerWheel::now() - m_started) / 1000U);
+}
+
+unsigned int CWheelTimer::getRemaining() const
+{
+	if (! isRunning())
+		return 0U;
+
+	uint64_t now = CTimerWheel::now();
+	if (now >= m_deadline)
+		return 0U;
+
+	return (unsigned int)((m_deadline - now) / 1000U);
+}
+
+bool CWheelTimer::isRunning() const
+{
+	return isLinked();
+}
+
+void CWheelTimer::start(unsigned int secs, unsigned int msecs)
+{
+	setTimeout(secs, msecs);
+
+	start();
+}
+
+void CWheelTimer::start()
+{
+	if (0U == m_timeout)
+		return;
+
+	stop();
+
+	m_started  = CTimerWheel::now();
+	m_deadline = m_started + m_timeout;
+
+	CTimerWheel::insert(this);
+}
+
+void CWheelTimer::stop()
+{
+	if (isRunning())
+		CTimerWheel::remove(this);
+}
+
+uint64_t CTimerWheel::now()
+{
+	return std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+void CTimerWheel::insert(CWheelTimer *timer)
+{
+	if (0U == m_now)
+		m_now = now();
+
+	// Anything already due goes in the next slot to be expired
+	uint64_t deadline = (timer->m_deadline > m_now) ? timer->m_deadline : m_now + 1U;
+	uint64_t delta = deadline - m_now;
+
+	unsigned int level = 0U;
+	while (level < WHEEL_LEVELS - 1U && delta >= (1ULL << (WHEEL_BITS * (level + 1U))))
+		level++;
+
+	unsigned int slot = (unsigned int)(deadline >> (WHEEL_BITS * level)) & (WHEEL_SLOTS - 1U);
+	m_slots[level][slot].append(timer);
+	m_count++;
+}
+
+void CTimerWheel::remove(CWheelTimer *timer)
+{
+	timer->unlink();
+	m_count--;
+}
+
+// Move the timers in the current slot of a higher level down to where they now belong
+void CTimerWheel::cascade(unsigned int level)
+{
+	unsigned int slot = (unsigned int)(m_now >> (WHEEL_BITS * level)) & (WHEEL_SLOTS - 1U);
+	CTimerNode &head = m_slots[level][slot];
+
+	while (head.isLinked()) {
+		CWheelTimer *timer = static_cast<CWheelTimer *>(head.m_next);
+		remove(timer);
+		insert(timer);
+	}
+}
+
+void CTimerWheel::clock()
+{
+	uint64_t target = now();
+
+	if (0U == m_now)
+		m_now = target;
+
+	while (m_now < target) {
+		if (0U == m_count) {
+			m_now = target;
+			break;
+		}
+
+		m_now++;
+
+		for (unsigned int level = WHEEL_LEVELS - 1U; level > 0U; level--) {
+			if (0U == (m_now & ((1ULL << (WHEEL_BITS * level)) - 1U)))
+				cascade(level);
+		}
+
+		// Take the expired timers off the wheel first, the callbacks may start,
+		// stop or even delete timers, including the others in this list
+		CTimerNode expired;
+		CTimerNode &head = m_slots[0][m_now & (WHEEL_SLOTS - 1U)];
+		while (head.isLinked()) {
+			CTimerNode *node = head.m_next;
+			node->unlink();
+			expired.append(node);
+		}
+
+		while (expired.isLinked()) {
+			CWheelTimer *timer = static_cast<CWheelTimer *>(expired.m_next);
+			remove(timer);
+			if (timer->m_owner)
+				timer->m_owner->timerExpired(*timer);
+		}
+	}
+}
+
+unsigned int CTimerWheel::getTimeout(unsigned int max)
+{
+	if (0U == m_count)
+		return max;
+
+	// Never sleep past the next cascade, the higher levels may have timers due
+	// just after it. Before then, wake up for the first busy slot on level 0.
+	uint64_t next = ((m_now >> WHEEL_BITS) + 1U) << WHEEL_BITS;
+	for (uint64_t tick = m_now + 1U; tick < next && tick <= m_now + max; tick++) {
+		if (m_slots[0][tick & (WHEEL_SLOTS - 1U)].isLinked()) {
+			next = tick;
+			break;
+		}
+	}
+
+	uint64_t current = now();
+	if (next <= current)
+		return 0U;
+
+	uint64_t timeout = next - current;
+	return (timeout < max) ? (unsigned int)timeout : max;
+}
+
+unsigned int CTimerWheel::getCount()
+{
+	return m_count;
+}
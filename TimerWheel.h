@@ -0,0 +1,98 @@
+/*
+ *   Copyright (c) 2018 by Thomas A. Early N7TAE
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation; either version 2 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+
+#pragma once
+
+#include <cstdint>
+
+#include "TimerCallback.h"
+
+// A node in one of the intrusive, circular slot lists of the timer wheel
+class CTimerNode {
+public:
+	CTimerNode();
+
+	bool isLinked() const;
+	void unlink();
+	void append(CTimerNode *node);
+
+	CTimerNode *m_prev;
+	CTimerNode *m_next;
+};
+
+// A one-shot millisecond timer. While running it is scheduled on the CTimerWheel
+// and the owner's timerExpired() is called once its deadline has passed.
+class CWheelTimer : private CTimerNode {
+public:
+	CWheelTimer(ITimerCallback *owner, unsigned int secs = 0U, unsigned int msecs = 0U);
+	~CWheelTimer();
+
+	void setTimeout(unsigned int secs, unsigned int msecs = 0U);
+
+	unsigned int getTimeout() const;	// in seconds
+	unsigned int getTimer() const;		// seconds since it was started
+	unsigned int getRemaining() const;	// seconds until it expires
+
+	bool isRunning() const;
+
+	void start(unsigned int secs, unsigned int msecs = 0U);
+	void start();
+	void stop();
+
+private:
+	friend class CTimerWheel;
+
+	CWheelTimer(const CWheelTimer &) = delete;
+	CWheelTimer &operator=(const CWheelTimer &) = delete;
+
+	ITimerCallback *m_owner;
+	uint64_t        m_timeout;		// ms
+	uint64_t        m_started;		// ms
+	uint64_t        m_deadline;		// ms
+};
+
+const unsigned int WHEEL_LEVELS = 4U;
+const unsigned int WHEEL_BITS   = 8U;
+const unsigned int WHEEL_SLOTS  = 1U << WHEEL_BITS;
+
+// A hierarchical timing wheel with a 1 ms resolution, driven by the monotonic clock.
+// Level 0 covers the next 256 ms, each higher level covers 256 times as much,
+// so clock() only touches the timers that have actually expired.
+class CTimerWheel {
+public:
+	static uint64_t now();
+
+	// Expire every timer whose deadline has passed
+	static void clock();
+
+	// How long, in ms, until the next deadline on the wheel, but never more than max
+	static unsigned int getTimeout(unsigned int max);
+
+	static unsigned int getCount();
+
+private:
+	friend class CWheelTimer;
+
+	static void insert(CWheelTimer *timer);
+	static void remove(CWheelTimer *timer);
+	static void cascade(unsigned int level);
+
+	static CTimerNode   m_slots[WHEEL_LEVELS][WHEEL_SLOTS];
+	static uint64_t     m_now;
+	static unsigned int m_count;
+};
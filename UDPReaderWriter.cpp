@@ -25,12 +25,22 @@ CUDPReaderWriter::CUDPReaderWriter(const std::string& address, unsigned int port
 m_address(address),
 m_port(port),
 m_addr(),
-m_fd(-1)
+m_fd(-1),
+m_batch(NULL),
+m_msgs(NULL),
+m_iovecs(NULL),
+m_addrs(NULL),
+m_count(0U),
+m_next(0U)
 {
 }
 
 CUDPReaderWriter::~CUDPReaderWriter()
 {
+	delete[] m_batch;
+	delete[] m_msgs;
+	delete[] m_iovecs;
+	delete[] m_addrs;
 }
 
 in_addr CUDPReaderWriter::lookup(const std::string& hostname)
@@ -94,29 +104,14 @@ bool CUDPReaderWriter::open()
 
 int CUDPReaderWriter::read(unsigned char* buffer, unsigned int length, in_addr& address, unsigned int& port)
 {
-	// Check that the readfrom() won't block
-	fd_set readFds;
-	FD_ZERO(&readFds);
-	FD_SET(m_fd, &readFds);
-
-	// Return immediately
-	timeval tv;
-	tv.tv_sec  = 0L;
-	tv.tv_usec = 0L;
-
-	int ret = ::select(m_fd + 1, &readFds, NULL, NULL, &tv);
-	if (ret < 0) {
-		printf("Error returned from UDP select (port: %u), err: %s\n", m_port, strerror(errno));
-		return -1;
-	}
-
-	if (ret == 0)
-		return 0;
-
 	sockaddr_in addr;
 	socklen_t size = sizeof(sockaddr_in);
 
-	ssize_t len = ::recvfrom(m_fd, (char*)buffer, length, 0, (sockaddr *)&addr, &size);
+	// The caller has been told the socket is readable, or is polling it, so never block here
+	ssize_t len = ::recvfrom(m_fd, (char*)buffer, length, MSG_DONTWAIT, (sockaddr *)&addr, &size);
+	if (len < 0 && (errno == EAGAIN || errno == EWOULDBLOCK))
+		return 0;
+
 	if (len <= 0) {
 		printf("Error returned from recvfrom (port: %u), err: %s\n", m_port, strerror(errno));
 		return -1;
@@ -128,6 +123,59 @@ int CUDPReaderWriter::read(unsigned char* buffer, unsigned int length, in_addr&
 	return len;
 }
 
+int CUDPReaderWriter::readNext(const unsigned char*& buffer, in_addr& address, unsigned int& port)
+{
+	for (;;) {
+		if (m_next >= m_count && !readBatch())
+			return 0;
+
+		unsigned int i = m_next++;
+		if (0U == m_msgs[i].msg_len)
+			continue;
+
+		buffer  = m_batch + i * UDP_BUFFER_LENGTH;
+		address = m_addrs[i].sin_addr;
+		port    = ntohs(m_addrs[i].sin_port);
+
+		return m_msgs[i].msg_len;
+	}
+}
+
+bool CUDPReaderWriter::readBatch()
+{
+	m_count = m_next = 0U;
+
+	// The buffers are only allocated for the sockets that are read in batches
+	if (NULL == m_batch) {
+		m_batch  = new unsigned char[UDP_BATCH_SIZE * UDP_BUFFER_LENGTH];
+		m_msgs   = new mmsghdr[UDP_BATCH_SIZE];
+		m_iovecs = new iovec[UDP_BATCH_SIZE];
+		m_addrs  = new sockaddr_in[UDP_BATCH_SIZE];
+	}
+
+	::memset(m_msgs, 0x00, UDP_BATCH_SIZE * sizeof(mmsghdr));
+	for (unsigned int i = 0U; i < UDP_BATCH_SIZE; i++) {
+		m_iovecs[i].iov_base = m_batch + i * UDP_BUFFER_LENGTH;
+		m_iovecs[i].iov_len  = UDP_BUFFER_LENGTH;
+		m_msgs[i].msg_hdr.msg_iov     = &m_iovecs[i];
+		m_msgs[i].msg_hdr.msg_iovlen  = 1;
+		m_msgs[i].msg_hdr.msg_name    = &m_addrs[i];
+		m_msgs[i].msg_hdr.msg_namelen = sizeof(sockaddr_in);
+	}
+
+	// The caller has been told the socket is readable, so never block here
+	int n = ::recvmmsg(m_fd, m_msgs, UDP_BATCH_SIZE, MSG_DONTWAIT, NULL);
+	if (n < 0) {
+		if (errno != EAGAIN && errno != EWOULDBLOCK)
+			printf("Error returned from recvmmsg (port: %u), err: %s\n", m_port, strerror(errno));
+		return false;
+	}
+
+	m_count = n;
+
+	return m_count > 0U;
+}
+
 bool CUDPReaderWriter::write(const unsigned char* buffer, unsigned int length, const in_addr& address, unsigned int port)
 {
 	sockaddr_in addr;
@@ -149,12 +197,66 @@ bool CUDPReaderWriter::write(const unsigned char* buffer, unsigned int length, c
 	return true;
 }
 
+bool CUDPReaderWriter::write(const unsigned char* buffer, unsigned int length, const std::vector<sockaddr_in>& destinations)
+{
+	iovec iov;
+	iov.iov_base = (void *)buffer;
+	iov.iov_len  = length;
+
+	unsigned int count = destinations.size();
+
+	// The workers share this socket, so every sending thread keeps its own
+	// headers. They only grow, so after the first stream nothing is allocated.
+	static thread_local std::vector<mmsghdr> msgs;
+	if (msgs.size() < count && msgs.size() < UDP_SEND_BATCH_SIZE)
+		msgs.resize(count < UDP_SEND_BATCH_SIZE ? count : UDP_SEND_BATCH_SIZE);
+
+	bool ok = true;
+	unsigned int sent = 0U;
+	while (sent < count) {
+		unsigned int n = count - sent;
+		if (n > UDP_SEND_BATCH_SIZE)
+			n = UDP_SEND_BATCH_SIZE;
+
+		::memset(msgs.data(), 0x00, n * sizeof(mmsghdr));
+		for (unsigned int i = 0U; i < n; i++) {
+			msgs[i].msg_hdr.msg_iov     = &iov;
+			msgs[i].msg_hdr.msg_iovlen  = 1;
+			msgs[i].msg_hdr.msg_name    = (void *)&destinations[sent + i];
+			msgs[i].msg_hdr.msg_namelen = sizeof(sockaddr_in);
+		}
+
+		int ret = ::sendmmsg(m_fd, msgs.data(), n, 0);
+		if (ret < 0) {
+			if (errno == EINTR)
+				continue;
+			// Only the first datagram has failed, skip it and carry on with the rest
+			printf("Error returned from sendmmsg (port: %u), err: %s\n", m_port, strerror(errno));
+			ok = false;
+			sent++;
+		} else
+			sent += ret;
+	}
+
+	return ok;
+}
+
 void CUDPReaderWriter::close()
 {
-	::close(m_fd);
+	if (m_fd >= 0) {
+		::close(m_fd);
+		m_fd = -1;
+	}
+
+	m_count = m_next = 0U;
 }
 
 unsigned int CUDPReaderWriter::getPort() const
 {
 	return m_port;
 }
+
+int CUDPReaderWriter::getFD() const
+{
+	return m_fd;
+}
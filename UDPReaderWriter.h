@@ -20,6 +20,7 @@
 #pragma once
 
 #include <string>
+#include <vector>
 #include <netdb.h>
 #include <sys/time.h>
 #include <sys/types.h>
@@ -29,6 +30,12 @@
 #include <arpa/inet.h>
 #include <errno.h>
 
+// recvmmsg() fills up to this many datagrams per call
+const unsigned int UDP_BATCH_SIZE    = 32U;
+// sendmmsg() takes up to UIO_MAXIOV datagrams, more than any group has repeaters
+const unsigned int UDP_SEND_BATCH_SIZE = 1024U;
+// big enough for the largest D-Star datagram, a 519 byte DCS connect
+const unsigned int UDP_BUFFER_LENGTH = 1024U;
 
 class CUDPReaderWriter {
 public:
@@ -40,15 +47,30 @@ public:
 	bool open();
 
 	int  read(unsigned char* buffer, unsigned int length, in_addr& address, unsigned int& port);
+	// Batched read: returns the next received datagram, refilling the batch with one recvmmsg()
+	// when it's used up. buffer points into the batch and is valid until the next call.
+	int  readNext(const unsigned char*& buffer, in_addr& address, unsigned int& port);
 	bool write(const unsigned char* buffer, unsigned int length, const in_addr& address, unsigned int port);
+	// Send the same datagram to every destination, with as few sendmmsg() calls as possible
+	bool write(const unsigned char* buffer, unsigned int length, const std::vector<sockaddr_in>& destinations);
 
 	void close();
 
 	unsigned int getPort() const;
+	int          getFD() const;
 
 private:
 	std::string       m_address;
 	unsigned short m_port;
 	in_addr        m_addr;
 	int            m_fd;
+
+	unsigned char* m_batch;
+	mmsghdr*       m_msgs;
+	iovec*         m_iovecs;
+	sockaddr_in*   m_addrs;
+	unsigned int   m_count;
+	unsigned int   m_next;
+
+	bool readBatch();
 };
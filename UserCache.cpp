@@ -18,38 +18,87 @@
  */
 
 #include "UserCache.h"
+#include "Utils.h"
 
-CUserCache::CUserCache()
+// Unbounded until setLimits() is given the configured limits
+CUserCache::CUserCache() :
+m_cache(0U, 0U)
 {
 }
 
 CUserCache::~CUserCache()
 {
-	for (std::unordered_map<std::string, CUserRecord *>::iterator it = m_cache.begin(); it != m_cache.end(); ++it)
-		delete it->second;
-	m_cache.clear();
 }
 
-CUserRecord* CUserCache::find(const std::string& user)
+const CUserRecord* CUserCache::find(const CCallsign& user) const
 {
-	return m_cache[user];
+	return m_cache.find(user);
 }
 
-void CUserCache::update(const std::string& user, const std::string& repeater, const std::string& timestamp)
+void CUserCache::update(const CCallsign& user, const CCallsign& repeater, const std::string& timestamp)
 {
-	CUserRecord* rec = m_cache[user];
+	time_t time = CUtils::parseTime(timestamp);
+
+	CUserRecord* rec = m_cache.peek(user);
 
 	if (rec == NULL)
 		// A brand new record is needed
-		m_cache[user] = new CUserRecord(user, repeater, timestamp);
-	else if(timestamp.compare(rec->getTimeStamp()) > 0) {
-		// Update an existing record, but only if the received timestamp is newer
+		m_cache.insert(user, CUserRecord(user, repeater, time));
+	else if (time >= rec->getTimeStamp() || m_cache.hasExpired(user)) {
+		// Update an existing record unless the received timestamp is older. The
+		// reply to a FIND repeats the timestamp, and must bring a timed out record back.
 		rec->setRepeater(repeater);
-		rec->setTimestamp(timestamp);
+		rec->setTimestamp(time);
+		m_cache.touch(user);
+	}
+}
+
+void CUserCache::setLimits(unsigned int capacity, unsigned int ttl)
+{
+	m_cache.setLimits(capacity, ttl);
+}
+
+struct SUserSnapshot {
+	uint64_t m_user;
+	uint64_t m_repeater;
+	int64_t  m_timestamp;
+	int64_t  m_updated;
+};
+
+void CUserCache::save(CSnapshotWriter &snapshot, unsigned int section) const
+{
+	m_cache.forEach([&](const CCallsign &key, time_t updated, const CUserRecord &rec) {
+		SUserSnapshot s = { key.getValue(), rec.getRepeater().getValue(), int64_t(rec.getTimeStamp()), int64_t(updated) };
+		snapshot.add(section, &s, sizeof(SUserSnapshot));
+	});
+}
+
+unsigned int CUserCache::load(const CSnapshotReader &snapshot, unsigned int section)
+{
+	unsigned int count;
+	const SUserSnapshot *s = snapshot.getSection<SUserSnapshot>(section, count);
+
+	for (unsigned int i = 0U; i < count; i++) {
+		CCallsign user(CCallsign::fromValue(s[i].m_user));
+		m_cache.insert(user, CUserRecord(user, CCallsign::fromValue(s[i].m_repeater), time_t(s[i].m_timestamp)), time_t(s[i].m_updated));
 	}
+
+	return count;
+}
+
+unsigned int CUserCache::expire()
+{
+	return m_cache.expire();
 }
 
 unsigned int CUserCache::getCount() const
 {
-	return m_cache.size();
+	return m_cache.getCount();
+}
+
+void CUserCache::getStats(unsigned long &hits, unsigned long &misses, unsigned long &evictions) const
+{
+	hits      = m_cache.getHits();
+	misses    = m_cache.getMisses();
+	evictions = m_cache.getEvictions();
 }
@@ -19,47 +19,51 @@
 
 #pragma once
 
+#include <ctime>
 #include <string>
-#include <unordered_map>
+
+#include "SnapshotFile.h"
+#include "LRUCache.h"
+#include "Callsign.h"
 
 class CUserRecord {
 public:
-	CUserRecord(const std::string& user, const std::string& repeater, const std::string& timestamp) :
+	CUserRecord(const CCallsign& user, const CCallsign& repeater, time_t timestamp) :
 	m_user(user),
 	m_repeater(repeater),
 	m_timestamp(timestamp)
 	{
 	}
 
-	std::string getUser() const
+	CCallsign getUser() const
 	{
 		return m_user;
 	}
 
-	std::string getRepeater() const
+	CCallsign getRepeater() const
 	{
 		return m_repeater;
 	}
 
-	std::string getTimeStamp() const
+	time_t getTimeStamp() const
 	{
 		return m_timestamp;
 	}
 
-	void setRepeater(const std::string& repeater)
+	void setRepeater(const CCallsign& repeater)
 	{
 		m_repeater = repeater;
 	}
 
-	void setTimestamp(const std::string& timestamp)
+	void setTimestamp(time_t timestamp)
 	{
 		m_timestamp = timestamp;
 	}
 
 private:
-	std::string m_user;
-	std::string m_repeater;
-	std::string m_timestamp;
+	CCallsign m_user;
+	CCallsign m_repeater;
+	time_t    m_timestamp;		// from ircDDB, parsed once
 };
 
 class CUserCache {
@@ -67,12 +71,22 @@ public:
 	CUserCache();
 	~CUserCache();
 
-	CUserRecord* find(const std::string& user);
+	const CUserRecord* find(const CCallsign& user) const;
+
+	void update(const CCallsign& user, const CCallsign& repeater, const std::string& timestamp);
+
+	void setLimits(unsigned int capacity, unsigned int ttl);
+
+	// Snapshots for a warm restart
+	void save(CSnapshotWriter &snapshot, unsigned int section) const;
+	unsigned int load(const CSnapshotReader &snapshot, unsigned int section);
 
-	void update(const std::string& user, const std::string& repeater, const std::string& timestamp);
+	// Drop the records that are too old to be found
+	unsigned int expire();
 
 	unsigned int getCount() const;
+	void getStats(unsigned long &hits, unsigned long &misses, unsigned long &evictions) const;
 
 private:
-	std::unordered_map<std::string, CUserRecord *> m_cache;
+	CLRUCache<CUserRecord> m_cache;
 };
@@ -0,0 +1,143 @@
+/*
+ *   Copyright (c) 2018 by Thomas A. Early N7TAE
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation; either version 2 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+
+
+#include <cstdio>
+
+#include "UserLookup.h"
+
+// A FIND that hasn't been answered by then is sent again
+const time_t LOOKUP_PENDING_SECS  = 10;
+// How long ircDDB's "don't know" is believed
+const time_t LOOKUP_NEGATIVE_SECS = 60;
+
+CUserLookup::CUserLookup(CCacheManager *cache) :
+m_cache(cache),
+m_irc(NULL),
+m_pending(),
+m_negative(),
+m_sent(0UL),
+m_coalesced(0UL),
+m_suppressed(0UL)
+{
+}
+
+CUserLookup::~CUserLookup()
+{
+}
+
+void CUserLookup::setIRC(CIRCDDB *irc)
+{
+	m_irc = irc;
+}
+
+bool CUserLookup::find(const std::string &callsign, CUserData &data)
+{
+	CCallsign key(callsign);
+	time_t now = ::time(NULL);
+
+	// a user ircDDB doesn't know can't be in the cache either
+	if (isNegative(key, now))
+		return false;
+
+	if (m_cache->findUser(callsign, data))
+		return true;
+
+	send(callsign, key, now);
+	return false;
+}
+
+void CUserLookup::request(const std::string &callsign)
+{
+	CUserData data;
+	find(callsign, data);
+}
+
+void CUserLookup::replied(const std::string &callsign, bool found)
+{
+	CCallsign key(callsign);
+
+	m_pending.erase(key);
+
+	if (found)
+		m_negative.erase(key);
+	else
+		m_negative[key] = ::time(NULL);
+}
+
+void CUserLookup::clean()
+{
+	time_t now = ::time(NULL);
+
+	for (auto it = m_pending.begin(); it != m_pending.end(); ) {
+		if (now - it->second > LOOKUP_PENDING_SECS)
+			it = m_pending.erase(it);
+		else
+			++it;
+	}
+
+	for (auto it = m_negative.begin(); it != m_negative.end(); ) {
+		if (now - it->second > LOOKUP_NEGATIVE_SECS)
+			it = m_negative.erase(it);
+		else
+			++it;
+	}
+}
+
+void CUserLookup::printStats() const
+{
+	printf("User lookups: %lu FINDs sent, %lu coalesced, %lu answered from the negative cache, %u pending, %u negative\n",
+		m_sent, m_coalesced, m_suppressed, (unsigned int)m_pending.size(), (unsigned int)m_negative.size());
+}
+
+bool CUserLookup::isNegative(const CCallsign &key, time_t now)
+{
+	auto it = m_negative.find(key);
+	if (m_negative.end() == it)
+		return false;
+
+	if (now - it->second > LOOKUP_NEGATIVE_SECS) {
+		m_negative.erase(it);
+		return false;
+	}
+
+	m_suppressed++;
+	return true;
+}
+
+void CUserLookup::send(const std::string &callsign, const CCallsign &key, time_t now)
+{
+	if (NULL == m_irc)
+		return;
+
+	auto it = m_pending.find(key);
+	if (m_pending.end() != it && now - it->second <= LOOKUP_PENDING_SECS) {
+		m_coalesced++;
+		return;
+	}
+
+	// ircDDB answers "not found" straight away when it isn't logged in,
+	// that isn't worth remembering so the FIND waits for the connection
+	if (m_irc->getConnectionState() < 6)
+		return;
+
+	if (m_irc->findUser(callsign)) {
+		m_pending[key] = now;
+		m_sent++;
+	}
+}
@@ -0,0 +1,67 @@
+/*
+ *   Copyright (c) 2018 by Thomas A. Early N7TAE
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation; either version 2 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+
+
+#pragma once
+
+#include <ctime>
+#include <string>
+#include <unordered_map>
+
+#include "CacheManager.h"
+#include "Callsign.h"
+#include "IRCDDB.h"
+
+// Stands between the groups and ircDDB for user lookups. Only one FIND is
+// outstanding for a callsign at a time, and a user ircDDB doesn't know about
+// isn't asked for again until the negative answer has aged out. Replies go
+// into the cache and the groups are told through CGroupHandler::cacheUpdated().
+// Everything here runs on the routing thread.
+class CUserLookup {
+public:
+	CUserLookup(CCacheManager *cache);
+	~CUserLookup();
+
+	void setIRC(CIRCDDB *irc);
+
+	// True with the cached record, or false and a FIND is sent if needed
+	bool find(const std::string &callsign, CUserData &data);
+
+	// Make sure a FIND is on its way if the user isn't cached
+	void request(const std::string &callsign);
+
+	// An IDRT_USER reply, found is false if ircDDB has no address for the user
+	void replied(const std::string &callsign, bool found);
+
+	// Forget the FINDs and negative answers that are too old to matter
+	void clean();
+
+	void printStats() const;
+
+private:
+	CCacheManager *m_cache;
+	CIRCDDB       *m_irc;
+	std::unordered_map<CCallsign, time_t> m_pending;	// when the FIND was sent
+	std::unordered_map<CCallsign, time_t> m_negative;	// when ircDDB said it didn't know
+	unsigned long  m_sent;
+	unsigned long  m_coalesced;
+	unsigned long  m_suppressed;
+
+	bool isNegative(const CCallsign &key, time_t now);
+	void send(const std::string &callsign, const CCallsign &key, time_t now);
+};
@@ -411,8 +411,11 @@ std::vector<std::string> CUtils::stringTokenizer(const std::string &s)
 
 time_t CUtils::parseTime(const std::string str)
 {
+	// ircDDB times are UTC
 	struct tm stm;
-	strptime(str.c_str(), "%Y-%m-%d %H:%M:%S", &stm);
-	return mktime(&stm);
+	memset(&stm, 0, sizeof(struct tm));
+	if (NULL == strptime(str.c_str(), "%Y-%m-%d %H:%M:%S", &stm))
+		return 0;
+	return timegm(&stm);
 }
 
@@ -0,0 +1,65 @@
+/*
+ *   Copyright (c) 2018 by Thomas A. Early N7TAE
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation; either version 2 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+
+#include "CCITTChecksum.h"
+#include "CCITTReference.h"
+
+// The old byte at a time CRC against the slicing-by-8 one, on the 39 byte
+// radio header that every G2 header and slow data header is checked over
+const unsigned int BENCH_LENGTH = 39U;
+const unsigned int BENCH_LOOPS  = 10000000U;
+
+int main()
+{
+	CCCITTReference ref;
+
+	unsigned char data[BENCH_LENGTH];
+	for (unsigned int i = 0U; i < BENCH_LENGTH; i++)
+		data[i] = ::rand() & 0xFFU;
+
+	// the results are summed, so neither loop can be optimised away
+	unsigned int sink = 0U;
+
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+	for (unsigned int n = 0U; n < BENCH_LOOPS; n++) {
+		data[0] = n;
+		sink += ref.update(0xFFFFU, data, BENCH_LENGTH);
+	}
+	std::chrono::duration<double, std::nano> old = std::chrono::steady_clock::now() - start;
+
+	start = std::chrono::steady_clock::now();
+	for (unsigned int n = 0U; n < BENCH_LOOPS; n++) {
+		data[0] = n;
+		CCCITTChecksum sum;
+		sum.update(data, BENCH_LENGTH);
+		unsigned char out[2];
+		sum.result(out);
+		sink += out[0] | (out[1] << 8);
+	}
+	std::chrono::duration<double, std::nano> now = std::chrono::steady_clock::now() - start;
+
+	printf("CRC-CCITT over %u bytes: byte at a time %.1f ns, slicing-by-8 %.1f ns (%u)\n",
+		BENCH_LENGTH, old.count() / BENCH_LOOPS, now.count() / BENCH_LOOPS, sink & 0x01U);
+
+	return 0;
+}
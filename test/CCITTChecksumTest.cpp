@@ -0,0 +1,114 @@
+/*
+ *   Copyright (c) 2018 by Thomas A. Early N7TAE
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation; either version 2 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+
+
+#include <cstdio>
+#include <cstdlib>
+
+#include "CCITTChecksum.h"
+#include "CCITTReference.h"
+
+// Exhaustive over every one and two byte input, then random buffers of every
+// length up to 256, fed in pieces split at random points
+static unsigned int failures = 0U;
+
+static void expect(bool ok, const char *what, unsigned int n)
+{
+	if (!ok && failures++ < 10U)
+		printf("FAIL: %s, case %u\n", what, n);
+}
+
+static uint16_t crcOf(CCCITTChecksum &sum)
+{
+	unsigned char out[2];
+	sum.result(out);
+	return uint16_t(~(out[0] | (out[1] << 8)));
+}
+
+int main()
+{
+	CCCITTReference ref;
+
+	// the table the old code used is the bitwise CRC of each byte
+	for (unsigned int i = 0U; i < 256U; i++)
+		expect(CCCITTReference::bitwise(0U, i) == ref.m_tab[i], "table", i);
+
+	unsigned char data[256U];
+
+	for (unsigned int i = 0U; i < 256U; i++) {
+		data[0] = i;
+		CCCITTChecksum sum;
+		sum.update(data, 1U);
+		expect(crcOf(sum) == ref.update(0xFFFFU, data, 1U), "one byte", i);
+	}
+
+	for (unsigned int i = 0U; i < 65536U; i++) {
+		data[0] = i >> 8;
+		data[1] = i & 0xFFU;
+		CCCITTChecksum sum;
+		sum.update(data, 2U);
+		expect(crcOf(sum) == ref.update(0xFFFFU, data, 2U), "two bytes", i);
+	}
+
+	::srand(1U);
+	for (unsigned int n = 0U; n < 200000U; n++) {
+		unsigned int length = n % 257U;
+		for (unsigned int i = 0U; i < length; i++)
+			data[i] = ::rand() & 0xFFU;
+
+		CCCITTChecksum sum;
+		unsigned int done = 0U;
+		while (done < length) {
+			unsigned int part = 1U + ::rand() % (length - done);
+			sum.update(data + done, part);
+			done += part;
+		}
+		expect(crcOf(sum) == ref.update(0xFFFFU, data, length), "random split", n);
+
+		// check() accepts its own result and rejects a flipped bit
+		CCCITTChecksum a, b, c;
+		unsigned char out[2];
+		a.update(data, length);
+		a.result(out);
+		b.update(data, length);
+		expect(b.check(out), "check", n);
+		out[n & 1U] ^= 1U << (n % 8U);
+		c.update(data, length);
+		expect(!c.check(out), "check flipped", n);
+	}
+
+	// the bool update handles one byte, most significant bit first
+	for (unsigned int i = 0U; i < 256U; i++) {
+		bool bits[8];
+		for (unsigned int b = 0U; b < 8U; b++)
+			bits[b] = (i & (0x80U >> b)) != 0U;
+
+		CCCITTChecksum sum;
+		sum.update(bits);
+		data[0] = i;
+		expect(crcOf(sum) == ref.update(0xFFFFU, data, 1U), "bool byte", i);
+	}
+
+	if (failures) {
+		printf("CCITTChecksumTest: %u failures\n", failures);
+		return 1;
+	}
+
+	printf("CCITTChecksumTest: OK\n");
+	return 0;
+}
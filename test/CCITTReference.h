@@ -0,0 +1,52 @@
+/*
+ *   Copyright (c) 2018 by Thomas A. Early N7TAE
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation; either version 2 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+
+
+#pragma once
+
+#include <cstdint>
+
+// The CRC-CCITT as it was before slicing-by-8: the same 256 entry table,
+// rebuilt here bit by bit from the D-Star polynomial, and a byte at a time
+// update. The tests and benchmarks compare CCCITTChecksum against it.
+class CCCITTReference {
+public:
+	CCCITTReference()
+	{
+		for (unsigned int i = 0U; i < 256U; i++)
+			m_tab[i] = bitwise(0U, i);
+	}
+
+	// One byte with no table at all, the definition of the CRC
+	static uint16_t bitwise(uint16_t crc, unsigned int byte)
+	{
+		crc ^= byte;
+		for (unsigned int i = 0U; i < 8U; i++)
+			crc = (crc & 0x0001U) ? (crc >> 1) ^ 0x8408U : (crc >> 1);
+		return crc;
+	}
+
+	uint16_t update(uint16_t crc, const unsigned char *data, unsigned int length) const
+	{
+		while (length-- > 0U)
+			crc = (crc >> 8) ^ m_tab[(crc & 0x00FFU) ^ *data++];
+		return crc;
+	}
+
+	uint16_t m_tab[256U];
+};
@@ -0,0 +1,103 @@
+/*
+ *   Copyright (c) 2018 by Thomas A. Early N7TAE
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation; either version 2 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+
+
+
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+#include <unistd.h>
+#include <arpa/inet.h>
+
+#include "CacheManager.h"
+#include "SnapshotFile.h"
+
+// The repeaters from the ircDDB table snapshot come back as replies without
+// an address. They have to route through their own gateway as soon as its
+// address is known, and survive a cache snapshot and reload.
+static unsigned int failures = 0U;
+
+static void expect(bool ok, const char *what)
+{
+	if (!ok) {
+		printf("FAIL: %s\n", what);
+		failures++;
+	}
+}
+
+static bool routes(CCacheManager &cache, const char *repeater, const char *gateway, const char *address)
+{
+	CRepeaterData data;
+	if (!cache.findRepeater(repeater, data))
+		return false;
+
+	in_addr addr = data.getAddress();
+	return 0 == data.getGateway().compare(gateway) && 0 == ::strcmp(::inet_ntoa(addr), address);
+}
+
+int main()
+{
+	char tmpName[] = "/tmp/CacheSnapshotTestXXXXXX";
+	int fd = ::mkstemp(tmpName);
+	if (fd < 0) {
+		printf("CacheSnapshotTest: cannot create a temporary file\n");
+		return 1;
+	}
+	::close(fd);
+
+	CCacheManager cache;
+
+	std::vector<CIRCDDBReply> replies(2U);
+	replies[0].m_type = IDRT_REPEATER;
+	replies[0].m_repeater = "N7TAE  B";
+	replies[0].m_gateway  = "W1ABC  G";
+	replies[1].m_type = IDRT_REPEATER;
+	replies[1].m_repeater = "K2DEF  C";
+	replies[1].m_gateway  = "K2DEF  G";
+	cache.update(replies, 2U);
+
+	CRepeaterData data;
+	expect(!cache.findRepeater("N7TAE  B", data), "found before its gateway has an address");
+
+	cache.updateGateway("W1ABC  G", "10.0.0.1", DP_DEXTRA, false, false);
+	cache.updateGateway("N7TAE  G", "10.0.0.2", DP_DEXTRA, false, false);
+	cache.updateGateway("K2DEF  G", "10.0.0.3", DP_DEXTRA, false, false);
+
+	expect(routes(cache, "N7TAE  B", "W1ABC  G", "10.0.0.1"), "non-standard pair not routed through its gateway");
+	expect(routes(cache, "K2DEF  C", "K2DEF  G", "10.0.0.3"), "standard pair not routed through its gateway");
+
+	CSnapshotWriter *snapshot = cache.save();
+	expect(snapshot->save(tmpName), "snapshot not written");
+	delete snapshot;
+
+	CCacheManager loaded;
+	expect(loaded.load(tmpName), "snapshot not loaded");
+	expect(routes(loaded, "N7TAE  B", "W1ABC  G", "10.0.0.1"), "non-standard pair lost in the snapshot");
+	expect(routes(loaded, "K2DEF  C", "K2DEF  G", "10.0.0.3"), "gateway lost in the snapshot");
+
+	::unlink(tmpName);
+
+	if (failures > 0U) {
+		printf("CacheSnapshotTest: %u failures\n", failures);
+		return 1;
+	}
+
+	printf("CacheSnapshotTest: OK\n");
+	return 0;
+}
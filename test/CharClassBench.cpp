@@ -0,0 +1,78 @@
+/*
+ *   Copyright (c) 2018 by Thomas A. Early N7TAE
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation; either version 2 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+
+
+
+#include <chrono>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#include "CharClass.h"
+#include "CharClassReference.h"
+
+// The std::regex checks against the lookup tables, on the fields of a
+// typical ircDDB table line and on the six callsigns cleaned in sendHeard
+const unsigned int BENCH_LOOPS = 200000U;
+
+static unsigned int sink = 0U;
+
+template <class F> static double timeIt(F f)
+{
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+	for (unsigned int n = 0U; n < BENCH_LOOPS; n++)
+		f();
+	std::chrono::duration<double, std::nano> t = std::chrono::steady_clock::now() - start;
+	return t.count() / BENCH_LOOPS;
+}
+
+int main()
+{
+	CCharClassReference ref;
+
+	const std::string table("0"), date("2018-05-21"), time("12:34:56"), key("N7TAE__B"), value("N7TAE__G");
+	const std::vector<std::string> heard = { "N7TAE   ", "ID51", "CQCQCQ  ", "N7TAE  B", "N7TAE  G", "XRF757 A" };
+
+	double oldLine = timeIt([&]() {
+		sink += ref.isTableID(table) + ref.isDate(date) + ref.isTime(time) + ref.isDBKey(key) + ref.isDBKey(value);
+	});
+	double newLine = timeIt([&]() {
+		sink += CCharClass::isTableID(table) + CCharClass::isDate(date) + CCharClass::isTime(time) +
+			CCharClass::isDBKey(key) + CCharClass::isDBKey(value);
+	});
+
+	double oldHeard = timeIt([&]() {
+		for (auto it = heard.begin(); it != heard.end(); ++it) {
+			std::string s(*it);
+			ref.replaceCallsign(s);
+			sink += s[0];
+		}
+	});
+	double newHeard = timeIt([&]() {
+		for (auto it = heard.begin(); it != heard.end(); ++it) {
+			std::string s(*it);
+			CCharClass::replace(s, CC_CALLSIGN, '_');
+			sink += s[0];
+		}
+	});
+
+	printf("ircDDB table line fields: std::regex %.1f ns, lookup table %.1f ns\n", oldLine, newLine);
+	printf("sendHeard callsigns:      std::regex %.1f ns, lookup table %.1f ns (%u)\n", oldHeard, newHeard, sink & 0x01U);
+
+	return 0;
+}
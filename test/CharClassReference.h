@@ -0,0 +1,78 @@
+/*
+ *   Copyright (c) 2018 by Thomas A. Early N7TAE
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation; either version 2 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+
+
+
+#pragma once
+
+#include <regex>
+#include <string>
+
+// The std::regex checks and clean ups that CCharClass replaced, kept as they
+// were in IRCDDBApp to test and time the lookup tables against
+class CCharClassReference {
+public:
+	CCharClassReference()
+	: tablePattern("^[0-9]$")
+	, datePattern("^20[0-9][0-9]-((1[0-2])|(0[1-9]))-((3[01])|([12][0-9])|(0[1-9]))$")
+	, timePattern("^((2[0-3])|([01][0-9])):[0-5][0-9]:[0-5][0-9]$")
+	, dbPattern("^[0-9A-Z_]{8}$")
+	, callsignNonValid("[^A-Z0-9/_]")
+	, qthNonValid("[^a-zA-Z0-9 +&(),./'-]")
+	, graphNonValid("[^[:graph:]]")
+	{
+	}
+
+	bool isTableID(const std::string &s) const { return std::regex_match(s, tablePattern); }
+	bool isDate(const std::string &s) const    { return std::regex_match(s, datePattern); }
+	bool isTime(const std::string &s) const    { return std::regex_match(s, timePattern); }
+	bool isDBKey(const std::string &s) const   { return std::regex_match(s, dbPattern); }
+
+	// sendHeard
+	void replaceCallsign(std::string &s) const
+	{
+		std::smatch sm;
+		while (std::regex_search(s, sm, callsignNonValid))
+			s[sm.position(0)] = '_';
+	}
+
+	// rptrQTH descriptions
+	void removeQTH(std::string &s) const
+	{
+		std::smatch sm;
+		while (std::regex_search(s, sm, qthNonValid))
+			s.erase(sm.position(0), sm.length());
+	}
+
+	// rptrQTH URL and kickWatchdog text
+	void removeGraph(std::string &s) const
+	{
+		std::smatch sm;
+		while (std::regex_search(s, sm, graphNonValid))
+			s.erase(sm.position(0), sm.length());
+	}
+
+private:
+	std::regex tablePattern;
+	std::regex datePattern;
+	std::regex timePattern;
+	std::regex dbPattern;
+	std::regex callsignNonValid;
+	std::regex qthNonValid;
+	std::regex graphNonValid;
+};
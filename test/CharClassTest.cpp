@@ -0,0 +1,124 @@
+/*
+ *   Copyright (c) 2018 by Thomas A. Early N7TAE
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation; either version 2 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+
+
+
+#include <cctype>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+
+#include "CharClass.h"
+#include "CharClassReference.h"
+
+// Each lookup table check and clean up against the std::regex it replaced:
+// every byte in every position of a valid field, every two digit value of
+// each date and time field, then random strings
+static unsigned int failures = 0U;
+
+static CCharClassReference ref;
+
+static void check(const std::string &s)
+{
+	bool ok = ref.isTableID(s) == CCharClass::isTableID(s) && ref.isDBKey(s) == CCharClass::isDBKey(s) &&
+		ref.isDate(s) == CCharClass::isDate(s) && ref.isTime(s) == CCharClass::isTime(s);
+
+	std::string a(s), b(s);
+	ref.replaceCallsign(a);
+	CCharClass::replace(b, CC_CALLSIGN, '_');
+	ok = ok && a == b;
+
+	a = b = s;
+	ref.removeQTH(a);
+	CCharClass::remove(b, CC_QTH);
+	ok = ok && a == b;
+
+	a = b = s;
+	ref.removeGraph(a);
+	CCharClass::remove(b, CC_GRAPH);
+	ok = ok && a == b;
+
+	if (!ok && failures++ < 10U) {
+		printf("FAIL: \"");
+		for (auto it = s.begin(); it != s.end(); ++it)
+			printf(isprint((unsigned char)*it) ? "%c" : "\\x%02x", (unsigned char)*it);
+		printf("\"\n");
+	}
+}
+
+// every byte in every position
+static void mutate(const std::string &valid)
+{
+	check(valid);
+	for (unsigned int i = 0U; i < valid.size(); i++) {
+		for (unsigned int c = 0U; c < 256U; c++) {
+			std::string s(valid);
+			s[i] = char(c);
+			check(s);
+		}
+	}
+	check(valid.substr(1U));
+	check(valid + "0");
+}
+
+static std::string twoDigits(unsigned int n)
+{
+	return std::string(1U, char('0' + n / 10U)) + char('0' + n % 10U);
+}
+
+int main()
+{
+	check("");
+	for (unsigned int c = 0U; c < 256U; c++) {
+		check(std::string(1U, char(c)));
+		for (unsigned int d = 0U; d < 256U; d++)
+			check(std::string(1U, char(c)) + char(d));
+	}
+
+	mutate("N7TAE__B");
+	mutate("2018-05-21");
+	mutate("12:34:56");
+
+	for (unsigned int i = 0U; i < 100U; i++) {
+		for (unsigned int j = 0U; j < 100U; j++) {
+			check("20" + twoDigits(i) + "-" + twoDigits(j) + "-15");
+			check("2018-" + twoDigits(i) + "-" + twoDigits(j));
+			check(twoDigits(i) + ":" + twoDigits(j) + ":00");
+			check("12:" + twoDigits(i) + ":" + twoDigits(j));
+		}
+	}
+
+	// mostly characters that are in at least one class
+	const std::string alphabet("0123456789ABCDEFGHIJKLMNOPQRSTUVWXYZabcxyz_/ +&(),./'-:~\t\n\x7f\x80\xff");
+	::srand(1U);
+	for (unsigned int n = 0U; n < 100000U; n++) {
+		std::string s;
+		unsigned int length = ::rand() % 25U;
+		for (unsigned int i = 0U; i < length; i++)
+			s += alphabet[::rand() % alphabet.size()];
+		check(s);
+	}
+
+	if (failures > 0U) {
+		printf("CharClassTest: %u failures\n", failures);
+		return 1;
+	}
+
+	printf("CharClassTest: OK\n");
+	return 0;
+}
@@ -0,0 +1,114 @@
+/*
+ *   Copyright (c) 2018 by Thomas A. Early N7TAE
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation; either version 2 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+
+
+
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <string>
+#include <thread>
+#include <unistd.h>
+#include <arpa/inet.h>
+
+#include "CacheManager.h"
+#include "HostResolver.h"
+
+// A reflector from the host files can only be linked once its address is in
+// the cache. This resolves one through /etc/hosts and one that can't be,
+// checks when each is known and that the addresses come back from the
+// resolver's cache file at the next start.
+static unsigned int failures = 0U;
+
+static void expect(bool ok, const char *what)
+{
+	if (!ok) {
+		printf("FAIL: %s\n", what);
+		failures++;
+	}
+}
+
+static bool isAddress(CCacheManager &cache, const std::string &reflector, const char *address)
+{
+	CRepeaterData data;
+	if (!cache.findRepeater(reflector, data))
+		return false;
+
+	in_addr addr = data.getAddress();
+	return 0 == ::strcmp(::inet_ntoa(addr), address);
+}
+
+// The worker threads finish on their own, this only bounds how long to wait
+static bool waitFor(CHostResolver &resolver)
+{
+	for (unsigned int i = 0U; i < 300U && resolver.isBusy(); i++)
+		std::this_thread::sleep_for(std::chrono::milliseconds(100));
+	return !resolver.isBusy();
+}
+
+int main()
+{
+	char tmpName[] = "/tmp/HostResolverTestXXXXXX";
+	int fd = ::mkstemp(tmpName);
+	if (fd < 0) {
+		printf("HostResolverTest: cannot create a temporary file\n");
+		return 1;
+	}
+	::close(fd);
+	::unlink(tmpName);
+	std::string cacheFile(tmpName);
+
+	{
+		CCacheManager cache;
+		CHostResolver resolver(&cache);
+		resolver.setCacheFile(cacheFile);
+		resolver.add("XRF999 G", "localhost", DP_DEXTRA, false);
+		resolver.add("XRF998 G", "no-such-reflector.invalid", DP_DEXTRA, false);
+
+		expect(!isAddress(cache, "XRF999 A", "127.0.0.1"), "known before it was resolved");
+		expect(!resolver.isBusy(), "busy before it was started");
+
+		resolver.start();
+		expect(waitFor(resolver), "still busy after 30 seconds");
+
+		expect(isAddress(cache, "XRF999 A", "127.0.0.1"), "localhost not in the cache");
+		CRepeaterData data;
+		expect(!cache.findRepeater("XRF998 A", data), "unresolvable host in the cache");
+	}
+
+	// The next start has the address before anything is looked up
+	{
+		CCacheManager cache;
+		CHostResolver resolver(&cache);
+		resolver.setCacheFile(cacheFile);
+		resolver.add("XRF999 G", "localhost", DP_DEXTRA, false);
+
+		expect(isAddress(cache, "XRF999 A", "127.0.0.1"), "localhost not loaded from the cache file");
+	}
+
+	::unlink(cacheFile.c_str());
+
+	if (failures > 0U) {
+		printf("HostResolverTest: %u failures\n", failures);
+		return 1;
+	}
+
+	printf("HostResolverTest: OK\n");
+	return 0;
+}
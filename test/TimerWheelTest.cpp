@@ -0,0 +1,101 @@
+/*
+ *   Copyright (c) 2018 by Thomas A. Early N7TAE
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation; either version 2 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+
+
+
+#include <chrono>
+#include <cstdio>
+#include <thread>
+
+#include "TimerWheel.h"
+
+// A timer on level 1 is only moved down at the next 256 ms cascade, so the
+// main loop must not sleep past it, even when a level 0 slot beyond the
+// cascade is busy with a later timer
+static unsigned int failures = 0U;
+
+static void expect(bool ok, const char *what)
+{
+	if (!ok) {
+		printf("FAIL: %s\n", what);
+		failures++;
+	}
+}
+
+class CFired : public ITimerCallback {
+public:
+	CFired() :
+	m_at(0U)
+	{
+	}
+
+	virtual void timerExpired(CWheelTimer &)
+	{
+		m_at = CTimerWheel::now();
+	}
+
+	uint64_t m_at;
+};
+
+static void waitForTick(uint64_t from, uint64_t to)
+{
+	for (;;) {
+		uint64_t tick = CTimerWheel::now() & (WHEEL_SLOTS - 1U);
+		if (tick >= from && tick <= to)
+			return;
+		std::this_thread::sleep_for(std::chrono::microseconds(200));
+	}
+}
+
+int main()
+{
+	CFired early, late;
+	CWheelTimer earlyTimer(&early), lateTimer(&late);
+
+	// Over 256 ms away, so on level 1 until the cascade
+	waitForTick(10U, 30U);
+	CTimerWheel::clock();
+	earlyTimer.start(0U, 300U);
+	uint64_t deadline = CTimerWheel::now() + 300U;
+
+	// Less than 256 ms away, so on level 0, but due after the early one
+	waitForTick(100U, 150U);
+	CTimerWheel::clock();
+	lateTimer.start(0U, 240U);
+
+	uint64_t current  = CTimerWheel::now();
+	uint64_t cascade  = ((current >> WHEEL_BITS) + 1U) << WHEEL_BITS;
+	unsigned int wait = CTimerWheel::getTimeout(1000U);
+	expect(current + wait <= cascade, "sleeps past the next cascade");
+
+	// The loop in CSGSThread::run() with nothing else to wake it
+	while (0U == early.m_at) {
+		std::this_thread::sleep_for(std::chrono::milliseconds(CTimerWheel::getTimeout(1000U)));
+		CTimerWheel::clock();
+	}
+	expect(early.m_at < deadline + 40U, "level 1 timer fired late");
+	expect(0U == late.m_at, "later timer fired first");
+
+	if (failures > 0U) {
+		printf("TimerWheelTest: %u failures\n", failures);
+		return 1;
+	}
+
+	printf("TimerWheelTest: OK\n");
+	return 0;
+}
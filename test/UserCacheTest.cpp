@@ -0,0 +1,116 @@
+/*
+ *   Copyright (c) 2018 by Thomas A. Early N7TAE
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation; either version 2 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+
+
+
+#include <chrono>
+#include <cstdio>
+#include <ctime>
+#include <thread>
+
+#include "LRUCache.h"
+#include "UserCache.h"
+
+// The CLOCK eviction order at capacity, the ttl, and a user whose record has
+// timed out being brought back by the reply to a FIND with the same timestamp
+static unsigned int failures = 0U;
+
+static void expect(bool ok, const char *what)
+{
+	if (!ok) {
+		printf("FAIL: %s\n", what);
+		failures++;
+	}
+}
+
+static CUserRecord record(const char *user)
+{
+	return CUserRecord(CCallsign(user), CCallsign("N7TAE  B"), 0);
+}
+
+int main()
+{
+	// A found record gets a second chance, the oldest unused one goes
+	{
+		CLRUCache<CUserRecord> cache(3U, 0U);
+		cache.insert(CCallsign("AAAA    "), record("AAAA    "));
+		cache.insert(CCallsign("BBBB    "), record("BBBB    "));
+		cache.insert(CCallsign("CCCC    "), record("CCCC    "));
+		expect(NULL != cache.find(CCallsign("AAAA    ")), "AAAA not found");
+
+		cache.insert(CCallsign("DDDD    "), record("DDDD    "));
+		expect(NULL != cache.peek(CCallsign("AAAA    ")), "used AAAA evicted");
+		expect(NULL == cache.peek(CCallsign("BBBB    ")), "unused BBBB kept");
+
+		// AAAA has had its second chance, CCCC is now the oldest
+		cache.insert(CCallsign("EEEE    "), record("EEEE    "));
+		expect(NULL == cache.peek(CCallsign("CCCC    ")), "unused CCCC kept");
+		expect(NULL != cache.peek(CCallsign("AAAA    ")) && NULL != cache.peek(CCallsign("DDDD    ")) &&
+			NULL != cache.peek(CCallsign("EEEE    ")), "newer records evicted");
+		expect(3U == cache.getCount() && 2UL == cache.getEvictions(), "wrong count after eviction");
+	}
+
+	// Records past the ttl are missing to find() and dropped by expire()
+	{
+		CLRUCache<CUserRecord> cache(0U, 10U);
+		cache.insert(CCallsign("OLD     "), record("OLD     "), ::time(NULL) - 100);
+		cache.insert(CCallsign("NEW     "), record("NEW     "));
+
+		expect(NULL == cache.find(CCallsign("OLD     ")), "timed out record found");
+		expect(cache.hasExpired(CCallsign("OLD     ")), "timed out record not expired");
+		expect(NULL != cache.find(CCallsign("NEW     ")), "fresh record not found");
+		expect(!cache.hasExpired(CCallsign("NEW     ")), "fresh record expired");
+
+		unsigned int live = 0U;
+		cache.forEach([&](const CCallsign &, time_t, const CUserRecord &) { live++; });
+		expect(1U == live, "forEach visited a timed out record");
+
+		expect(1U == cache.expire() && 1U == cache.getCount(), "expire() didn't drop just the old record");
+		expect(NULL == cache.peek(CCallsign("OLD     ")), "timed out record still there");
+	}
+
+	// ircDDB hasn't heard the user since, so the FIND reply repeats the timestamp
+	{
+		CUserCache cache;
+		cache.setLimits(0U, 1U);
+
+		CCallsign user("N7TAE   ");
+		cache.update(user, CCallsign("N7TAE  B"), "2018-05-21 12:34:56");
+		expect(NULL != cache.find(user), "new user not found");
+
+		std::this_thread::sleep_for(std::chrono::milliseconds(2100));
+		expect(NULL == cache.find(user), "timed out user found");
+
+		cache.update(user, CCallsign("N7TAE  C"), "2018-05-21 12:34:56");
+		const CUserRecord *rec = cache.find(user);
+		expect(NULL != rec, "FIND reply didn't bring the user back");
+		expect(NULL != rec && rec->getRepeater() == CCallsign("N7TAE  C"), "FIND reply's repeater not stored");
+
+		cache.update(user, CCallsign("N7TAE  D"), "2018-05-21 12:00:00");
+		rec = cache.find(user);
+		expect(NULL != rec && rec->getRepeater() == CCallsign("N7TAE  C"), "older timestamp replaced a live record");
+	}
+
+	if (failures > 0U) {
+		printf("UserCacheTest: %u failures\n", failures);
+		return 1;
+	}
+
+	printf("UserCacheTest: OK\n");
+	return 0;
+}